@@ -0,0 +1,263 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include "managers/Registry.h"
+#include "managers/ResourceManager.h"
+#include "systems/PhysicsSystem.h"
+#include "core/ThreadPool.h"
+#include "systems/NullRenderSystem.h"
+
+// Scenario benchmark driver, runs headless. Usage:
+//   bench_runner [--frames N] [--sizes 1000,10000,...] [--budget seconds] [--out file.json] [--lod]
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    int frames = 120;
+    std::vector<size_t> sizes = { 1000, 10000, 100000, 1000000 };
+    double budget = 60.0; // max seconds of simulated frames per scene
+    float deltaTime = 1.0f / 60.0f;
+    std::string out;
+    BroadphaseType broadphase = BROADPHASE_SPATIAL_HASH;
+    unsigned threads = 0; // physics threads, 0 for all
+    bool lod = false; // physics level of detail around a camera at the centre of the scene
+};
+
+struct SceneStats {
+    size_t entities = 0, statics = 0, bodies = 0, lights = 0;
+    double setupMs = 0;
+    int framesRun = 0;
+    bool truncated = false;
+    std::vector<std::pair<std::string, std::vector<double>>> systemSamples; // milliseconds
+    std::vector<double> frameSamples;
+    PhysicsStats physicsTotals; // every frame's step, merged with accumulate
+};
+
+static double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static std::vector<size_t> parseSizes(const std::string& list) {
+    std::vector<size_t> sizes;
+    std::stringstream s(list);
+    std::string token;
+    while (std::getline(s, token, ',')) {
+        if (!token.empty()) sizes.push_back(std::stoul(token));
+    }
+    return sizes;
+}
+
+// 90% static cubes on a floor, 9% falling physics bodies and 1% lights
+static void buildScene(size_t count, SceneStats& stats, std::shared_ptr<Shape> cube) {
+    Registry& registry = Registry::getInstance();
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> velocity(-2.0f, 2.0f);
+
+    stats.entities = count;
+    stats.lights = count / 100;
+    stats.bodies = count * 9 / 100;
+    stats.statics = count - stats.bodies - stats.lights;
+
+    Material material(cube, nullptr, 0.4f, 8);
+    int side = std::max(1, (int)std::sqrt((double)stats.statics));
+
+    for (int i = 0; i < (int)stats.statics; i++) {
+        Entity entity = registry.createEntity();
+        registry.addComponent(entity, Transform(Vec3(i % side - side / 2, 0, i / side - side / 2)));
+        registry.addComponent(entity, material);
+    }
+
+    for (int i = 0; i < (int)stats.bodies; i++) {
+        Entity entity = registry.createEntity();
+        Vec3 position(i % side - side / 2 + 0.5f, 2 + (i / (side * side)) * 2, (i / side) % side - side / 2 + 0.5f);
+        registry.addComponent(entity, Transform(position));
+        registry.addComponent(entity, Physics(Vec3(velocity(rng), 0, velocity(rng)), Vec3(0, -9.812, 0)));
+        registry.addComponent(entity, material);
+    }
+
+    for (int i = 0; i < (int)stats.lights; i++) {
+        Entity entity = registry.createEntity();
+        registry.addComponent(entity, Transform(Vec3(i % side - side / 2, 5, i / side - side / 2)));
+        registry.addComponent(entity, LightSource());
+    }
+}
+
+static void clearScene() {
+    Registry& registry = Registry::getInstance();
+    for (Entity entity : registry.getEntitiesWith(0)) {
+        registry.destroyEntity(entity);
+    }
+}
+
+static SceneStats runScene(size_t count, const BenchOptions& options, std::shared_ptr<Shape> cube) {
+    SceneStats stats;
+
+    auto setupStart = Clock::now();
+    buildScene(count, stats, cube);
+    stats.setupMs = elapsedMs(setupStart);
+
+    auto physics = std::make_shared<PhysicsSystem>(options.broadphase);
+    physics->setMaxThreads(options.threads);
+    if (options.lod) {
+        physics->setLODCamera(std::make_shared<Camera>(Vec3(0, 2, 0), Vec3(0, 1, 0), 0.0f, 0.0f, 90.0f, 1.0f, 0.1f, 1000.0f));
+    }
+    std::vector<std::shared_ptr<ISystem>> systems = {
+        physics,
+        std::make_shared<NullRenderSystem>(),
+    };
+    std::sort(systems.begin(), systems.end(), [](const auto& a, const auto& b) {
+        return a->getPriority() < b->getPriority();
+    });
+    for (auto& system : systems) {
+        stats.systemSamples.push_back({ system->getName(), {} });
+    }
+
+    double total = 0;
+    for (int frame = 0; frame < options.frames; frame++) {
+        auto frameStart = Clock::now();
+        for (size_t i = 0; i < systems.size(); i++) {
+            auto start = Clock::now();
+            systems[i]->update(options.deltaTime);
+            stats.systemSamples[i].second.push_back(elapsedMs(start));
+        }
+        double frameMs = elapsedMs(frameStart);
+        stats.frameSamples.push_back(frameMs);
+        stats.framesRun++;
+
+        stats.physicsTotals.accumulate(physics->getStats());
+
+        total += frameMs;
+        if (total / 1000.0 > options.budget && frame + 1 < options.frames) {
+            stats.truncated = true;
+            break;
+        }
+    }
+
+    clearScene();
+    return stats;
+}
+
+static void writeTiming(std::ostream& out, std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    double mean = 0;
+    for (double sample : samples) mean += sample;
+    mean /= std::max<size_t>(1, samples.size());
+
+    auto percentile = [&](double p) {
+        if (samples.empty()) return 0.0;
+        return samples[std::min(samples.size() - 1, (size_t)(p * (samples.size() - 1) + 0.5))];
+    };
+
+    out << "{\"mean_ms\":" << mean << ",\"p50_ms\":" << percentile(0.5) << ",\"p99_ms\":" << percentile(0.99)
+        << ",\"max_ms\":" << (samples.empty() ? 0.0 : samples.back()) << "}";
+}
+
+static void writeReport(std::ostream& out, const BenchOptions& options, const std::vector<SceneStats>& scenes) {
+    out << "{\n  \"frames\": " << options.frames << ",\n  \"delta_time\": " << options.deltaTime;
+    out << ",\n  \"broadphase\": \"" << (options.broadphase == BROADPHASE_AABB_TREE ? "tree" : "hash") << "\"";
+    out << ",\n  \"simd\": \"" << getSimdLevelName(getSimdLevel()) << "\"";
+    unsigned poolThreads = ThreadPool::getInstance().getThreadCount();
+    out << ",\n  \"lod\": " << (options.lod ? "true" : "false");
+    out << ",\n  \"threads\": " << (options.threads ? std::min(options.threads, poolThreads) : poolThreads);
+    out << ",\n  \"scenes\": [";
+    for (size_t s = 0; s < scenes.size(); s++) {
+        const SceneStats& scene = scenes[s];
+        double totalMs = 0;
+        for (double sample : scene.frameSamples) totalMs += sample;
+
+        out << (s ? "," : "") << "\n    {\"entities\": " << scene.entities
+            << ", \"statics\": " << scene.statics << ", \"bodies\": " << scene.bodies << ", \"lights\": " << scene.lights
+            << ", \"setup_ms\": " << scene.setupMs << ", \"frames_run\": " << scene.framesRun
+            << ", \"truncated\": " << (scene.truncated ? "true" : "false")
+            << ",\n     \"entities_per_second\": " << (totalMs > 0 ? scene.entities * scene.framesRun / (totalMs / 1000.0) : 0.0)
+            << ",\n     \"frame\": ";
+        writeTiming(out, scene.frameSamples);
+        // Broadphase tuning numbers, per frame unless they say otherwise
+        const PhysicsStats& physics = scene.physicsTotals;
+        double frames = std::max(1, scene.framesRun);
+        double moves = std::max<uint64_t>(1, physics.moves);
+        out << ",\n     \"physics\": {\"awake_bodies\": " << physics.awakeBodies / frames
+            << ", \"stepped_bodies\": " << physics.steppedBodies / frames
+            << ", \"simplified_bodies\": " << physics.simplifiedBodies / frames
+            << ", \"sleeping_bodies\": " << physics.sleepingBodies / frames
+            << ", \"max_colliders\": " << physics.colliders << ", \"max_static_cubes\": " << physics.staticCubes
+            << ", \"moves\": " << physics.moves / frames
+            << ", \"candidates_per_move\": " << physics.broadphaseCandidates / moves
+            << ", \"narrowphase_tests_per_move\": " << physics.narrowphaseTests / moves
+            << ", \"substepped_bodies\": " << physics.substeppedBodies / frames
+            << ", \"collisions\": " << physics.collisions / frames
+            << ", \"body_contacts\": " << physics.bodyContacts / frames
+            << ", \"solver_contacts\": " << physics.solverContacts / frames
+            << ", \"solver_islands\": " << physics.solverIslands / frames
+            << ", \"max_solver_iterations\": " << physics.solverIterations
+            << ",\n      \"sync_ms\": " << physics.syncMs / frames << ", \"integrate_ms\": " << physics.integrateMs / frames
+            << ", \"solve_ms\": " << physics.solveMs / frames << ", \"collide_ms\": " << physics.collideMs / frames << ", \"write_back_ms\": " << physics.writeBackMs / frames
+            << ", \"contacts_ms\": " << physics.contactsMs / frames << ", \"islands_ms\": " << physics.islandsMs / frames
+            << ", \"total_ms\": " << physics.totalMs / frames << "}";
+        out << ",\n     \"systems\": {";
+        for (size_t i = 0; i < scene.systemSamples.size(); i++) {
+            out << (i ? "," : "") << "\n       \"" << scene.systemSamples[i].first << "\": ";
+            writeTiming(out, scene.systemSamples[i].second);
+        }
+        out << "}}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--sizes" && i + 1 < argc) {
+            options.sizes = parseSizes(argv[++i]);
+        } else if (arg == "--budget" && i + 1 < argc) {
+            options.budget = std::atof(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.out = argv[++i];
+        } else if (arg == "--broadphase" && i + 1 < argc) {
+            std::string type = argv[++i];
+            options.broadphase = (type == "tree") ? BROADPHASE_AABB_TREE : BROADPHASE_SPATIAL_HASH;
+        } else if (arg == "--simd" && i + 1 < argc) {
+            std::string level = argv[++i];
+            setSimdLevel(level == "scalar" ? SIMD_SCALAR : level == "sse" ? SIMD_SSE : SIMD_AVX2);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--lod") {
+            options.lod = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--frames N] [--sizes 1000,10000] [--budget seconds] [--out file.json] [--broadphase hash|tree] [--simd scalar|sse|avx2] [--threads N] [--lod]\n";
+            return -1;
+        }
+    }
+
+    // Benchmarks never open a window, resources are only parsed
+    auto& RM = ResourceManager::getInstance();
+    RM.setHeadless(true);
+    std::shared_ptr<Shape> cube = RM.getShape("lib/objects/cube.obj", true);
+
+    std::vector<SceneStats> scenes;
+    for (size_t size : options.sizes) {
+        std::cerr << "Running scene with " << size << " entities..." << std::endl;
+        scenes.push_back(runScene(size, options, cube));
+    }
+
+    if (options.out.empty()) {
+        writeReport(std::cout, options, scenes);
+    } else {
+        std::ofstream file(options.out);
+        if (!file.is_open()) {
+            std::cerr << "Error opening output file: " << options.out << "\n";
+            return -1;
+        }
+        writeReport(file, options, scenes);
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <array>
+
+// Frame time statistics over the rolling window, in milliseconds
+struct FrameStats {
+    double mean = 0;
+    double p50 = 0;
+    double p99 = 0;
+    double max = 0;
+    double jitter = 0; // standard deviation
+};
+
+// High resolution frame timing and limiting. A frame is ended by sleeping with clock_nanosleep
+// until shortly before the deadline and then spinning on the performance counter for the rest.
+class FramePacer {
+    static constexpr size_t WINDOW = 240;        // frames kept for the rolling statistics
+    static constexpr double BUCKET_MS = 0.25;    // histogram resolution
+    static constexpr size_t BUCKETS = 256;       // last bucket collects everything above 64 ms
+
+    uint64_t frequency;
+    uint64_t frameStart;
+    uint64_t deadline = 0;
+
+    double targetRate = 0;      // 0 disables the limiter
+    double spinThreshold;       // seconds before the deadline where sleeping stops
+
+    std::array<double, WINDOW> frameTimes {}; // ring buffer of frame times (ms)
+    std::array<uint32_t, BUCKETS> histogram {}; // bucketed counts of the same window
+    size_t frameCount = 0;
+
+public:
+    FramePacer(double targetRate = 0, double spinThreshold = 0.002);
+
+    // Set the target frame rate in Hz, 0 runs unlimited
+    void setTargetRate(double rate);
+
+    double getTargetRate() const { return targetRate; }
+
+    // Wait for the next frame slot and return the time since the previous frame in seconds
+    float beginFrame();
+
+    FrameStats getStats() const;
+
+    // Counts per BUCKET_MS wide bucket over the rolling window
+    const std::array<uint32_t, BUCKETS>& getHistogram() const { return histogram; }
+
+    double getBucketWidth() const { return BUCKET_MS; }
+
+private:
+    uint64_t now() const;
+
+    void waitUntil(uint64_t target);
+
+    void record(double frameMs);
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <time.h>
+
+// Scoped timing zones. Build with 'make PROFILE=1' (defines SWIFT_PROFILE) to compile them in,
+// otherwise PROFILE_ZONE expands to nothing and has no overhead at all.
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef SWIFT_PROFILE
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name)
+#endif
+
+struct ProfileEvent {
+    const char* name; // must be a string literal or otherwise outlive the profiler
+    uint64_t start;   // nanoseconds
+    uint64_t duration;
+};
+
+// One event of a ring buffer. 'sequence' is 2 * index + 1 while event 'index' is being written
+// and 2 * index + 2 once it's complete, so a reader can tell a torn or overwritten copy.
+struct ProfileSlot {
+    std::atomic<uint64_t> sequence { 0 };
+    std::atomic<const char*> name { nullptr };
+    std::atomic<uint64_t> start { 0 };
+    std::atomic<uint64_t> duration { 0 };
+};
+
+// Ring buffer of finished zones, one per thread. Only the owning thread writes to it, other
+// threads may read it at any time.
+struct ProfileBuffer {
+    static constexpr size_t CAPACITY = 1 << 16;
+
+    std::vector<ProfileSlot> slots;
+    std::atomic<uint64_t> head { 0 }; // total number of events written
+    uint32_t threadID;
+
+    ProfileBuffer(uint32_t threadID) : slots(CAPACITY), threadID(threadID) {}
+
+    // Copy event 'index' into 'event', false if it was overwritten or is being written
+    bool read(uint64_t index, ProfileEvent& event) const;
+};
+
+class Profiler {
+private:
+    Profiler() {}
+
+    std::mutex buffersMutex;
+    std::vector<std::unique_ptr<ProfileBuffer>> buffers;
+    uint64_t startTime = 0; // zones that started before this are ignored
+
+public:
+    static Profiler& getInstance() {
+        static Profiler instance;
+        return instance;
+    }
+
+    // Delete copy constructor and assignment operator
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    static uint64_t now() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    }
+
+    // Store a finished zone in the calling thread's ring buffer
+    void record(const char* name, uint64_t start, uint64_t end);
+
+    // Write every buffered zone as Chrome trace-event JSON (load it in chrome://tracing or Perfetto)
+    bool exportChromeTrace(const char* filepath);
+
+    // Drop all recorded zones
+    void clear();
+
+private:
+    ProfileBuffer& getThreadBuffer();
+};
+
+class ProfileZone {
+    const char* name;
+    uint64_t start;
+
+public:
+    ProfileZone(const char* name) : name(name), start(Profiler::now()) {}
+
+    ~ProfileZone() { Profiler::getInstance().record(name, start, Profiler::now()); }
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+// Worker threads for splitting loops over many items, e.g. bodies in the PhysicsSystem.
+// The calling thread works on the loop too and returns once every item is done.
+class ThreadPool {
+private:
+    ThreadPool();
+
+    std::vector<std::thread> workers;
+
+    std::mutex submitMutex; // one loop at a time
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+
+    // Loop being run
+    const std::function<void(size_t, size_t)>* job = nullptr;
+    size_t jobCount = 0;
+    size_t jobGrain = 1;
+    size_t chunkCount = 0;
+    std::atomic<size_t> nextChunk { 0 };
+
+    uint64_t generation = 0;  // bumped for every loop so sleeping workers notice it
+    unsigned openSlots = 0;   // workers that may still join the current loop
+    unsigned activeHelpers = 0;
+    bool stopping = false;
+
+    void workerLoop();
+
+    // Claim and run chunks until there are none left
+    void runChunks();
+
+public:
+    static ThreadPool& getInstance() {
+        static ThreadPool instance;
+        return instance;
+    }
+
+    ~ThreadPool();
+
+    // Delete copy constructor and assignment operator
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Workers plus the calling thread
+    unsigned getThreadCount() const { return (unsigned)workers.size() + 1; }
+
+    // Call body(begin, end) for consecutive ranges of at most 'grain' items covering [0, count).
+    // Ranges run in any order on up to maxThreads threads (0 for all), so body must only write
+    // to state owned by its range. Calls from inside a body run on the calling thread.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body,
+                     unsigned maxThreads = 0);
+};
+
+#endif
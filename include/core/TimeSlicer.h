@@ -0,0 +1,39 @@
+#ifndef TIMESLICER_H
+#define TIMESLICER_H
+
+#include <functional>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// A long running job split into small steps. Each call does one step and returns true when finished.
+using SlicedTask = std::function<bool()>;
+
+using SlicedTaskID = uint32_t;
+
+// Resumes sliced tasks across frames within a per-frame time budget
+class TimeSlicer {
+    // Shared so a step keeps running, with its state, if it cancels itself or adds tasks
+    struct TaskEntry {
+        SlicedTaskID id;
+        std::shared_ptr<SlicedTask> step;
+    };
+
+    std::vector<TaskEntry> tasks;
+    size_t nextTask = 0; // round robin position, so every task makes progress
+    SlicedTaskID nextID = 0;
+
+public:
+    SlicedTaskID add(SlicedTask task);
+
+    // Remove a task before it finishes, returns false if it is unknown or already done
+    bool cancel(SlicedTaskID id);
+
+    // Step tasks until they are all done or the budget (microseconds) is spent.
+    // A step is never interrupted, so keep steps well below the budget.
+    void run(uint32_t budgetMicros);
+
+    size_t size() const { return tasks.size(); }
+};
+
+#endif
@@ -34,6 +34,9 @@ public:
 
     Mat4x4 getMatCamera();
 
+    // Direction the rendered view looks along, the projection sees what lies behind 'front'
+    Vec3 getViewDirection() const { return -front; }
+
     void processKeyboardInput(const std::string& direction, float deltaTime, float speed);
 
     void processMouseInput(float xOffset, float yOffset, float sensitivity = 0.1f);
@@ -0,0 +1,67 @@
+#ifndef FRAMEPACKET_H
+#define FRAMEPACKET_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "graphics/Shape.h"
+#include "graphics/Shader.h"
+#include "graphics/TextureArrays.h"
+#include "linalg/linalg.h"
+
+// All instances of one shape drawn in a single call, from the batch's slots in GPU memory
+struct DrawBatch {
+    std::shared_ptr<Shape> shape; // null for a batch not in use
+    std::vector<uint16_t> textureArrays; // one draw each
+    uint32_t instanceCount = 0;
+};
+
+// Consecutive slots of a batch that changed, their new data starts at 'first' in the frame's instances
+struct InstanceRun {
+    uint32_t batch;
+    uint32_t slot;
+    uint32_t count;
+    uint32_t first;
+};
+
+// Immutable snapshot of everything needed to render one frame. Written by the simulation
+// thread and read by whoever submits it to GL, so it never points back into the registry.
+struct FramePacket {
+    Mat4x4 matCamera;
+    Vec3 eyePos;
+    std::vector<LightData> lights;
+
+    // Batches are kept between frames to reuse their allocations, only the first batchCount are used
+    std::vector<DrawBatch> batches;
+    size_t batchCount = 0;
+
+    // Slots to update before drawing. Single threaded mode writes their data straight into the GPU
+    // upload buffer and leaves 'instances' empty, pipelined mode stages it here for the render thread.
+    std::vector<InstanceRun> runs;
+    std::vector<InstanceData> instances;
+    size_t instanceCount = 0;
+
+    // Textures drawn for the first time, uploaded before anything is drawn
+    std::vector<TextureUpload> textureUploads;
+
+    // Shapes and textures let go of while preparing the packet. One may be the last reference to
+    // its GL objects, so they're only dropped on the GL thread once the packet was submitted.
+    std::vector<std::shared_ptr<void>> released;
+
+    // Empty the packet for the next frame, the resources it held move to 'released'
+    void clear() {
+        for (size_t i = 0; i < batchCount; i++) {
+            if (batches[i].shape) released.push_back(std::move(batches[i].shape));
+            batches[i].textureArrays.clear();
+            batches[i].instanceCount = 0;
+        }
+        batchCount = 0;
+        runs.clear();
+        instanceCount = 0;
+        for (TextureUpload& upload : textureUploads) released.push_back(std::move(upload.texture));
+        textureUploads.clear();
+        lights.clear();
+    }
+};
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef INSTANCEBUFFER_H
+#define INSTANCEBUFFER_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include "graphics/Shape.h"
+
+// Instance data of one batch kept on the GPU between frames. Slots are updated in place by copies
+// on the GPU, from wherever the new data was uploaded to. Must be used on the GL thread.
+class InstanceBuffer {
+    GLuint buffer = 0;
+    size_t capacity = 0; // instances
+
+public:
+    InstanceBuffer() {}
+    ~InstanceBuffer() { if (buffer) glDeleteBuffers(1, &buffer); }
+
+    InstanceBuffer(InstanceBuffer&& other) : buffer(other.buffer), capacity(other.capacity) {
+        other.buffer = 0;
+        other.capacity = 0;
+    }
+
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+    // Make room for 'count' instances, keeping the current ones
+    void reserve(size_t count);
+
+    // Copy 'count' instances from 'source', starting at instance 'first' there, to the slots from 'slot' on
+    void copy(GLuint source, size_t first, size_t slot, size_t count);
+
+    GLuint getBuffer() const { return buffer; }
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef INSTANCERING_H
+#define INSTANCERING_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include "graphics/Shape.h"
+
+// Instance data streamed through one persistently mapped buffer split into three regions. Each
+// frame writes the next region while the GPU may still read the previous two, a fence per region
+// makes sure it is done with one before it is written again. Must be used on the GL thread.
+class InstanceRing {
+    static constexpr int REGIONS = 3;
+
+    GLuint buffer = 0;
+    InstanceData* mapped = nullptr;
+    size_t capacity = 0; // instances per region
+    int region = 0;
+    GLsync fences[REGIONS] = {};
+
+    void waitForRegion(int region);
+    void allocate(size_t capacity);
+    void release();
+
+public:
+    InstanceRing() {}
+    ~InstanceRing() { release(); }
+
+    InstanceRing(const InstanceRing&) = delete;
+    InstanceRing& operator=(const InstanceRing&) = delete;
+
+    // Region to write this frame's 'count' instances to, grows the buffer if they don't fit.
+    // Null if the buffer couldn't be mapped.
+    InstanceData* beginFrame(size_t count);
+
+    // Fence the region after the frame's draw calls and move on to the next one
+    void endFrame();
+
+    GLuint getBuffer() const { return buffer; }
+
+    // Index of this frame's first instance in the buffer, the base instance to draw from
+    GLuint getBaseInstance() const { return (GLuint)(region * capacity); }
+};
+
+#endif
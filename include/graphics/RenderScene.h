@@ -0,0 +1,77 @@
+#ifndef RENDERSCENE_H
+#define RENDERSCENE_H
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <iterator>
+#include "graphics/FramePacket.h"
+#include "graphics/TextureArrays.h"
+#include "managers/Registry.h"
+
+// Instance slots of everything with a Material and a Transform, kept between frames. Every entity
+// has a slot in the batch of its shape, a batch's slots are packed so it draws all of them. update()
+// only rebuilds the slots of entities the registry lists as changed, a scene where nothing moves
+// costs next to nothing. Uses the registry's change list, so only one scene should exist at a time.
+class RenderScene {
+public:
+    struct Batch {
+        std::shared_ptr<Shape> shape; // null while the batch is unused
+        std::vector<uint16_t> textureArrays; // sampled by its instances, one draw each
+        std::vector<Entity> slots;
+        std::vector<uint32_t> dirtySlots;
+    };
+
+private:
+    uint32_t requiredComponents = MATERIAL_MASK | TRANSFORM_MASK;
+
+    Registry& registry = Registry::getInstance();
+
+    struct Slot {
+        uint32_t batch;
+        uint32_t slot;
+    };
+    std::unordered_map<Entity, Slot> slotOf;
+    std::vector<Batch> batches;
+    std::unordered_map<Shape*, uint32_t> batchOf;
+    std::vector<uint32_t> freeBatches;
+    TextureLayers textureLayers;
+    std::vector<std::shared_ptr<void>> released; // shapes of batches that emptied
+
+    std::vector<Entity> changed;
+    std::vector<InstanceRun> runs;
+    size_t instanceCount = 0; // in the runs
+    bool synced = false;
+
+    void addSlot(Entity entity);
+    void removeSlot(Entity entity);
+    InstanceData makeInstance(Batch& batch, Entity entity);
+
+public:
+    // Bring the slots up to date with the registry and list the changed ones as runs
+    void update();
+
+    // Write the new data of the runs' slots to 'instances', instanceCount of them in run order.
+    // Assigns texture layers, so read the batches' texture arrays and the uploads afterwards.
+    void writeInstances(InstanceData* instances);
+
+    // Textures that got a layer since the last call, to upload before the frame is drawn
+    void takeTextureUploads(std::vector<TextureUpload>& uploads) { textureLayers.takeUploads(uploads); }
+
+    // Move the shapes the scene let go of since the last call to 'result', to drop on the GL thread
+    void takeReleased(std::vector<std::shared_ptr<void>>& result) {
+        result.insert(result.end(), std::make_move_iterator(released.begin()), std::make_move_iterator(released.end()));
+        released.clear();
+    }
+
+    const std::vector<Batch>& getBatches() const { return batches; }
+
+    const std::vector<InstanceRun>& getRuns() const { return runs; }
+
+    size_t getInstanceCount() const { return instanceCount; }
+
+    // Renderables in the scene
+    size_t getSlotCount() const { return slotOf.size(); }
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef RENDERTHREAD_H
+#define RENDERTHREAD_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <functional>
+#include <SDL2/SDL.h>
+#include "graphics/FramePacket.h"
+
+// Triple buffered hand-off of frame packets. The simulation writes frame N+1 while
+// the render thread submits frame N, with at most one finished frame waiting in between:
+// beginWrite blocks until the render thread has taken the last one.
+class FramePipeline {
+    static constexpr int SLOTS = 3;
+
+    FramePacket packets[SLOTS];
+    std::vector<int> freeSlots;
+    std::deque<int> readySlots;
+    int writeSlot = -1;
+    int readSlot = -1;
+    bool stopped = false;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+
+public:
+    FramePipeline();
+
+    // Get a packet to fill, blocks while the render thread is too far behind. Returns nullptr once stopped.
+    FramePacket* beginWrite();
+
+    // Hand the packet from beginWrite to the render thread
+    void endWrite();
+
+    // Get the oldest finished packet, blocks until there is one. Returns nullptr once stopped.
+    FramePacket* beginRead();
+
+    // Give the packet from beginRead back to the simulation
+    void endRead();
+
+    void stop();
+};
+
+// Thread that owns the GL context and submits frame packets
+class RenderThread {
+    SDL_Window* window;
+    SDL_GLContext context;
+
+    FramePipeline pipeline;
+    std::thread thread;
+    bool running = false;
+
+public:
+    RenderThread(SDL_Window* window, SDL_GLContext context) : window(window), context(context) {}
+
+    ~RenderThread() { stop(); }
+
+    // Move the GL context to a new thread that calls submit for every packet
+    void start(std::function<void(const FramePacket&)> submit);
+
+    // Finish the thread and make the GL context current on the calling thread again
+    void stop();
+
+    FramePipeline& getPipeline() { return pipeline; }
+};
+
+#endif
@@ -50,7 +50,9 @@ public:
 
     void bindFloat(float f, const char* name);
 
-    void bindLights(std::vector<LightData> lights);
+    void bindUInt(GLuint value, const char* name);
+
+    void bindLights(const std::vector<LightData>& lights);
 };
 
 #endif
\ No newline at end of file
@@ -17,7 +17,7 @@ struct Vertex {
 
 struct InstanceData {
     Mat4x4 matWorld;
-    GLuint textureIndex; // Maps every instance to its texture
+    GLuint textureIndex; // Texture array and layer of the instance, see TextureLayer::pack
     GLuint shininess;
     float reflectivity;
 };
@@ -27,10 +27,11 @@ private:
     std::vector<Vertex> vertices;
     std::vector<GLushort> indices;
 
-    GLuint VAO; // Vertex Array Object (loading attribute pointers)
-    GLuint VBO; // Vertex Buffer Object (loading vertices)
-    GLuint IBO; // Index Buffer Object (loading indicies to vertices)
-    GLuint instanceVBO; // Instance buffer used to load instance specific data
+    GLuint VAO = 0; // Vertex Array Object (loading attribute pointers)
+    GLuint VBO = 0; // Vertex Buffer Object (loading vertices)
+    GLuint IBO = 0; // Index Buffer Object (loading indicies to vertices)
+
+    bool uploadToGPU; // false in headless mode, the shape is only parsed
 
     void loadByIndexArray(std::string filename);
     void loadByVertexArray(std::string filename);
@@ -40,15 +41,24 @@ private:
 
 public:
     ~Shape() { cleanup(); };
-    Shape(const char* shapeFile, bool loadByIndices = true);
+    Shape(const char* shapeFile, bool loadByIndices = true, bool uploadToGPU = true);
     
     void bindVAO() { glBindVertexArray(VAO); }
     
     void drawSingle();
 
-    void drawInstancesArray(std::vector<InstanceData>& instances);
+    // Draw 'count' instances read from instanceBuffer starting at baseInstance
+    void drawInstancesArray(GLuint instanceBuffer, GLuint baseInstance, GLsizei count);
+
+    void drawInstancesAtlas(const std::vector<InstanceData>& instances);
+
+    bool isOnGPU() const { return VAO != 0; }
+
+    // The parsed mesh stays in memory after the upload, mesh colliders read it from here
+    const std::vector<Vertex>& getVertices() const { return vertices; }
 
-    void drawInstancesAtlas(std::vector<InstanceData>& instances);
+    // Empty if the shape was loaded by vertex array, every three vertices are a triangle then
+    const std::vector<GLushort>& getIndices() const { return indices; }
 
     void printVericies();
 };
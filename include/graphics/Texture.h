@@ -10,11 +10,15 @@ class Texture {
     void loadTextureToGPU();
 
 public:
-    GLuint textureID;
+    GLuint textureID = 0;
 
-    SDL_Surface* surface;
+    SDL_Surface* surface = nullptr;
    
-    Texture(const char* textureFile);
+    // In headless mode (uploadToGPU = false) only the image data is loaded
+    Texture(const char* textureFile, bool uploadToGPU = true);
+
+    // Takes ownership of an RGBA32 surface
+    Texture(SDL_Surface* surface, bool uploadToGPU = true);
 
     ~Texture() {
         if (textureID) {
@@ -25,28 +29,4 @@ public:
     }    
 };
 
-class TextureArray {
-public:   
-    GLuint textureArrayID;
-
-    std::vector<std::shared_ptr<Texture>> array;
-
-    TextureArray() {
-        // Generate ID
-        glGenTextures(1, &textureArrayID);
-    }
-
-    ~TextureArray() {
-        // Cleanup
-        if (textureArrayID) {
-            glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
-            glDeleteTextures(1, &textureArrayID);
-        }        
-    }
-
-    // Loads the current array into GPU overwriting the last one
-    void loadTexturesToGPU();
-};
-
-
 #endif
\ No newline at end of file
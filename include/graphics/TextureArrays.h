@@ -0,0 +1,88 @@
+#ifndef TEXTUREARRAYS_H
+#define TEXTUREARRAYS_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <memory>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include "graphics/Texture.h"
+
+// Where a texture lives on the GPU, a layer of one of the texture arrays
+struct TextureLayer {
+    uint16_t array;
+    uint16_t layer;
+
+    // As stored in InstanceData::textureIndex
+    uint32_t pack() const { return (uint32_t)array << 16 | layer; }
+};
+
+// A texture to upload into its layer before anything samples it
+struct TextureUpload {
+    std::shared_ptr<Texture> texture;
+    TextureLayer layer;
+};
+
+// Gives every texture a layer the first time it's drawn, which it keeps for as long as it lives.
+// Textures of the same size and format share arrays of ARRAY_LAYERS layers, a full group gets
+// another array. Makes no GL calls, the uploads it queues are done by TextureArrays.
+class TextureLayers {
+public:
+    static constexpr uint16_t ARRAY_LAYERS = 16;
+    static constexpr uint16_t NO_ARRAY = 0xFFFF; // textures without image data are drawn white
+
+private:
+    struct Group {
+        std::vector<uint16_t> arrays;
+        uint16_t used = 0; // layers of the last array
+        std::vector<TextureLayer> freeLayers;
+    };
+    std::map<std::tuple<int, int, uint32_t>, Group> groups; // by width, height and pixel format
+    uint16_t arrayCount = 0;
+
+    struct Resident {
+        std::weak_ptr<Texture> texture;
+        TextureLayer layer;
+        Group* group;
+    };
+    std::unordered_map<Texture*, Resident> residents;
+
+    std::vector<TextureUpload> uploads;
+
+    // Hand the layers of textures that are gone back to their groups
+    void releaseExpired();
+
+public:
+    // Layer of 'texture', queues its upload the first time
+    TextureLayer getLayer(const std::shared_ptr<Texture>& texture);
+
+    // Move the uploads queued since the last call to 'result'
+    void takeUploads(std::vector<TextureUpload>& result);
+
+    size_t getArrayCount() const { return arrayCount; }
+
+    size_t getResidentCount() const { return residents.size(); }
+};
+
+// Immutable texture arrays with a full mip chain, each texture is uploaded once into the layer
+// TextureLayers gave it. Must be used on the GL thread.
+class TextureArrays {
+    std::vector<GLuint> arrays; // by TextureLayer::array
+
+    void allocate(uint16_t array, const SDL_Surface* surface);
+
+public:
+    TextureArrays() {}
+    ~TextureArrays();
+
+    TextureArrays(const TextureArrays&) = delete;
+    TextureArrays& operator=(const TextureArrays&) = delete;
+
+    void upload(const std::vector<TextureUpload>& uploads);
+
+    // Zero for an array nothing was uploaded to
+    GLuint getArray(uint16_t array) const { return array < arrays.size() ? arrays[array] : 0; }
+};
+
+#endif
@@ -47,7 +47,7 @@ public:
         if (it == components.end()) {
             throw std::runtime_error("Trying to access a non-existent component!");
         }
-        return components[entity];
+        return it->second; // lookup only, safe to call from several threads while nothing is added
     }
 
     void entityDestroyed(Entity entity) override {
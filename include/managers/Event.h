@@ -0,0 +1,32 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <any>
+#include <iostream>
+#include "EntityManager.h"
+
+enum EventType {
+    EVENT_QUIT = 0,
+    EVENT_KEYDOWN,
+    EVENT_KEYUP,
+    EVENT_MOUSEMOTION,
+    EVENT_TIMER, // generic event type for scheduled gameplay timers
+};
+
+struct Event {
+    EventType type;
+    std::any data;
+    Entity entity;  
+
+    template <typename T>
+    T castData() const {
+        try {
+            return std::any_cast<T>(data); // Cast the std::any to the desired type
+        } catch (const std::bad_any_cast& e) {
+            std::cerr << "Bad any_cast: " << e.what() << std::endl;
+            throw; // Rethrow the exception or handle it appropriately
+        }
+    }
+};
+
+#endif
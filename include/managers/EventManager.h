@@ -5,42 +5,21 @@
 #include <vector>
 #include <functional>
 #include <string>
-#include <any>
 #include <SDL2/SDL.h>
-#include "EntityManager.h"
+#include "Event.h"
+#include "TimerWheel.h"
 #include <memory>
 #include <iostream>
 
-enum EventType {
-    EVENT_QUIT = 0,
-    EVENT_KEYDOWN,
-    EVENT_KEYUP,
-    EVENT_MOUSEMOTION,
-};
-
-struct Event {
-    EventType type;
-    std::any data;
-    Entity entity;  
-
-    template <typename T>
-    T castData() const {
-        try {
-            return std::any_cast<T>(data); // Cast the std::any to the desired type
-        } catch (const std::bad_any_cast& e) {
-            std::cerr << "Bad any_cast: " << e.what() << std::endl;
-            throw; // Rethrow the exception or handle it appropriately
-        }
-    }
-};
-
-
 class EventManager {
 private:
     EventManager() {}
 
     std::queue<Event> eventQueue;
 
+    TimerWheel timers;
+    std::vector<Event> dueEvents;
+
 public:
     static EventManager& getInstance() {
         static EventManager instance;
@@ -57,6 +36,15 @@ public:
     // poll an event from the queue
     bool poll(Event& event);
 
+    // schedule an event to be published after 'delay' seconds, repeating every 'period' seconds if period > 0
+    TimerID schedule(const Event& event, float delay, float period = 0.0f);
+
+    // cancel a scheduled event, returns false if it already fired or was cancelled
+    bool cancel(TimerID timer);
+
+    // advance the timers and publish every event that became due
+    void advanceTimers(float deltaTime);
+
     // convertSDLevents to custom type Event
     void convertSDLEvents(SDL_Event& sdlEvent);
 };
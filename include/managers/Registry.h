@@ -10,6 +10,18 @@ class Registry {
 
     EntityManager entityManager;
 
+    uint64_t version = 0; // bumped whenever entities or components are added or removed
+
+    // Entity of each of the last version bumps, structureLog[i] bumped the version to structureLogStart + i + 1.
+    // Only the most recent ones are kept, readers that fall further behind have to start over.
+    static constexpr size_t STRUCTURE_LOG_SIZE = 1 << 16;
+    std::vector<Entity> structureLog;
+    uint64_t structureLogStart = 0;
+
+    // Entities changed since the last takeChanged, each listed once
+    std::vector<Entity> changedEntities;
+    std::vector<Entity> lastChanged; // by entity index (the upper 16 bits), entity listed + 1 or 0
+
     // Private constructor for Singleton
     Registry() {}
 
@@ -29,6 +41,8 @@ public:
     }
 
     void destroyEntity(Entity entity) {
+        bumpVersion(entity);
+
         // Remove from entitymanager
         entityManager.destroyEntity(entity);
 
@@ -49,12 +63,44 @@ public:
     std::vector<Entity> getEntitiesWith(uint32_t componentMask) {
         return entityManager.getEntitiesByMask(componentMask);
     }
+
+    // Systems compare this against a stored value to know when cached entity lists are stale
+    uint64_t getVersion() { return version; }
+
+    // Append the entities that were destroyed or had components added or removed since 'sinceVersion'
+    // to 'result', possibly more than once. False if the log no longer reaches back that far, the
+    // caller then has to look at every entity.
+    bool getStructureChanges(uint64_t sinceVersion, std::vector<Entity>& result) {
+        if (sinceVersion < structureLogStart || sinceVersion > version) return false;
+        result.insert(result.end(), structureLog.begin() + (sinceVersion - structureLogStart), structureLog.end());
+        return true;
+    }
+
+    // Components are changed in place through getComponent, whoever changes one that other systems
+    // keep derived state of (like the renderer's instance data) marks the entity here. Adding and
+    // removing components and destroying entities marks them too. Not thread safe.
+    void markChanged(Entity entity) {
+        uint32_t index = entity >> 16;
+        if (index >= lastChanged.size()) lastChanged.resize(index + 1, 0);
+        if (lastChanged[index] == entity + 1) return;
+        lastChanged[index] = entity + 1;
+        changedEntities.push_back(entity);
+    }
+
+    // Move the entities marked since the last call into 'result'. Meant for a single consumer, the
+    // render backend, as each entity is handed out once.
+    void takeChanged(std::vector<Entity>& result) {
+        result.clear();
+        result.swap(changedEntities);
+        for (Entity entity : result) lastChanged[entity >> 16] = 0;
+    }
     
     // Add a component of type T to an entity
     template <typename T>
     void addComponent(Entity entity, T component) {
         auto& array = getComponentArray<T>();
         array.add(entity, component);
+        bumpVersion(entity);
         entityManager.addComponentMask(entity, COMPONENT_MASKS.at(std::type_index(typeid(T))));
     }
 
@@ -63,6 +109,7 @@ public:
     void removeComponent(Entity entity) {
         auto& array = getComponentArray<T>();
         array.remove(entity);
+        bumpVersion(entity);
         entityManager.removeComponentMask(entity, COMPONENT_MASKS.at(std::type_index(typeid(T))));
     }
 
@@ -74,14 +121,27 @@ public:
     }
 
 private:
+    void bumpVersion(Entity entity) {
+        version++;
+        markChanged(entity);
+
+        // Drop the older half once the log is full, so appending stays cheap
+        structureLog.push_back(entity);
+        if (structureLog.size() >= 2 * STRUCTURE_LOG_SIZE) {
+            structureLog.erase(structureLog.begin(), structureLog.begin() + STRUCTURE_LOG_SIZE);
+            structureLogStart += STRUCTURE_LOG_SIZE;
+        }
+    }
+
     // Get the specific component array for type T, creating it if necessary
     template <typename T>
     ComponentArray<T>& getComponentArray() {
         auto type = std::type_index(typeid(T));
-        if (componentArrays.find(type) == componentArrays.end()) {
-            componentArrays[type] = std::make_unique<ComponentArray<T>>();
+        auto it = componentArrays.find(type);
+        if (it == componentArrays.end()) {
+            it = componentArrays.emplace(type, std::make_unique<ComponentArray<T>>()).first;
         }
-        return *static_cast<ComponentArray<T>*>(componentArrays[type].get());
+        return *static_cast<ComponentArray<T>*>(it->second.get());
     }
 };
 
@@ -4,9 +4,12 @@
 #include <unordered_map>
 #include <memory>
 #include <string>
+#include <stdexcept>
 #include "graphics/Shape.h"
 #include "graphics/Shader.h"
 #include "graphics/Texture.h"
+#include "physics/Heightfield.h"
+#include "physics/TriangleMesh.h"
 #include "linalg/linalg.h"
 
 // ObjectManager that manages shared resources
@@ -17,6 +20,10 @@ private:
     std::unordered_map<std::string, std::weak_ptr<Shape>> shapeCache;
     std::unordered_map<std::string, std::weak_ptr<Texture>> textureCache;
     std::unordered_map<std::string, std::weak_ptr<Shader>> shaderCache;
+    std::unordered_map<std::string, std::weak_ptr<Heightfield>> heightfieldCache; // keyed by file and cell size
+    std::unordered_map<std::string, std::weak_ptr<TriangleMesh>> triangleMeshCache;
+
+    bool headless = false;
 
 public:
     static ResourceManager& getInstance() {
@@ -28,11 +35,22 @@ public:
     ResourceManager(const ResourceManager&) = delete;
     ResourceManager& operator=(const ResourceManager&) = delete;
 
+    // In headless mode resources are parsed but never uploaded to the GPU
+    void setHeadless(bool headless) { this->headless = headless; }
+
+    bool isHeadless() { return headless; }
+
     std::shared_ptr<Shape> getShape(const char* shapeFile, bool loadByIndices = true);
 
     std::shared_ptr<Texture> getTexture(const char* textureFile);
 
     std::shared_ptr<Shader> getShader(const char* shaderFile);
+
+    // Terrain collider from an OBJ mesh, see Heightfield
+    std::shared_ptr<Heightfield> getHeightfield(const char* objFile, float cellSize = 1.0f);
+
+    // Mesh collider over the vertices of the shape loaded from the same file
+    std::shared_ptr<TriangleMesh> getTriangleMesh(const char* shapeFile);
 };
 
 #endif
\ No newline at end of file
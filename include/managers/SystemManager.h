@@ -12,6 +12,10 @@
 #include "systems/RenderSystem.h"
 #include "systems/InputSystem.h"
 #include "systems/PhysicsSystem.h"
+#include "systems/NullRenderSystem.h"
+#include "core/Profiler.h"
+#include "core/TimeSlicer.h"
+#include <cmath>
 
 enum GameState {
     NONE,
@@ -21,6 +25,10 @@ enum GameState {
     PAUSEMENU,
 };
 
+// Bitmasks of game states a system is enabled in
+#define STATE_BIT(state)    (1u << (state))
+#define ALL_STATES          0xFFFFFFFFu
+
 class SystemManager {
 private:
     SystemManager() {}
@@ -29,7 +37,25 @@ private:
 
     GameState state = INGAME;
 
-    std::vector<std::shared_ptr<ISystem>> systemExecutionOrder;
+    // Systems stay registered across state changes, switching state only flips 'active'
+    struct SystemEntry {
+        std::shared_ptr<ISystem> system;
+        uint32_t stateMask = ALL_STATES;
+        bool active = false;
+
+        // Tick scheduling for systems with a tick rate
+        double period = 0;      // seconds between ticks, 0 ticks every frame
+        double phase = 0;       // fraction of the period before the first tick
+        double nextTick = 0;    // time of the next tick on the manager clock
+        float accumulated = 0;  // time since the last tick
+    };
+
+    double elapsed = 0; // manager clock, advanced by update
+
+    TimeSlicer slicer;
+    uint32_t taskBudget = 1000; // microseconds of sliced tasks per frame
+
+    std::vector<SystemEntry> systemExecutionOrder;
     std::unordered_map<std::string, std::shared_ptr<ISystem>> systems;
 
 public:
@@ -44,14 +70,22 @@ public:
 
     GameState getState() { return state; }
 
-    void setState(GameState state) { this->state = state; }
+    void setState(GameState state) {
+        this->state = state;
+        for (auto& entry : systemExecutionOrder) {
+            updateActivation(entry);
+        }
+    }
 
     void clearSystems() {
+        for (auto& entry : systemExecutionOrder) {
+            if (entry.active) entry.system->onDeactivate();
+        }
         systems.clear();
         systemExecutionOrder.clear();
     }
 
-    // Function to add a system
+    // Function to add a system, it is enabled in every state until restricted with setSystemStates
     template <typename T, typename... Args>
     std::shared_ptr<T> registerSystem(Args&&... args) {
         std::string typeName = typeid(T).name();  // Get the type name as string
@@ -64,7 +98,22 @@ public:
         // Create and store the system
         auto newSystem = std::make_shared<T>(std::forward<Args>(args)...);
         systems[typeName] = newSystem;
-        systemExecutionOrder.push_back(newSystem);
+        SystemEntry entry = { newSystem };
+        float rate = newSystem->getTickRate();
+        if (rate > 0) {
+            entry.period = 1.0 / rate;
+            entry.phase = newSystem->getTickPhase();
+            if (entry.phase < 0) {
+                // Golden ratio spacing keeps systems with the same rate on different frames
+                int sameRate = 0;
+                for (const auto& other : systemExecutionOrder) {
+                    if (other.period == entry.period) sameRate++;
+                }
+                entry.phase = std::fmod(sameRate * 0.618034, 1.0);
+            }
+        }
+        systemExecutionOrder.push_back(entry);
+        updateActivation(systemExecutionOrder.back());
 
         // Reorder systems to ensure the correct execution order
         reorderSystems();
@@ -72,6 +121,22 @@ public:
         return newSystem;
     }
 
+    // Restrict a registered system to a bitmask of states, e.g. STATE_BIT(INGAME) | STATE_BIT(PAUSEMENU)
+    template <typename T>
+    void setSystemStates(uint32_t stateMask) {
+        auto it = systems.find(typeid(T).name());
+        if (it == systems.end()) {
+            throw std::runtime_error("System not found!");
+        }
+
+        for (auto& entry : systemExecutionOrder) {
+            if (entry.system == it->second) {
+                entry.stateMask = stateMask;
+                updateActivation(entry);
+            }
+        }
+    }
+
     // Function to remove a system
     template <typename T>
     void removeSystem() {
@@ -83,45 +148,95 @@ public:
         }
 
         // Remove from the map
+        auto system = systems[typeName];
         systems.erase(typeName);
 
         // Remove from the execution order
         systemExecutionOrder.erase(
             std::remove_if(systemExecutionOrder.begin(), systemExecutionOrder.end(),
-                        [&](const std::shared_ptr<ISystem>& sys) { 
-                            return std::string(typeid(*sys).name()) == typeName; 
+                        [&](const SystemEntry& entry) { 
+                            if (entry.system != system) return false;
+                            if (entry.active) entry.system->onDeactivate();
+                            return true;
                         }),
             systemExecutionOrder.end());
     }
 
     void processEvents(float deltaTime) {
+        // Timers that expired since last frame are dispatched with this frame's events
+        eventManager.advanceTimers(deltaTime);
+
         SDL_Event sdlEvent;
         eventManager.convertSDLEvents(sdlEvent);
 
         Event event;
         while (eventManager.poll(event)) {
-            if (event.type == EVENT_QUIT) state = QUIT;
-            for (const auto& system : systemExecutionOrder) {
-                system->processEvent(event, deltaTime); 
+            if (event.type == EVENT_QUIT) setState(QUIT);
+            for (const auto& entry : systemExecutionOrder) {
+                if (entry.active) entry.system->processEvent(event, deltaTime); 
             }
         }
     }
 
-    // Function to update all systems in the correct order
+    // Function to update all systems in the correct order, systems with a tick rate only run on their ticks
     void update(float deltaTime) {
-        for (auto system : systemExecutionOrder) {
-            system->update(deltaTime);
+        PROFILE_ZONE("SystemManager::update");
+        elapsed += deltaTime;
+        for (auto& entry : systemExecutionOrder) {
+            if (!entry.active) continue;
+
+            entry.accumulated += deltaTime;
+            if (entry.period > 0) {
+                if (elapsed < entry.nextTick) continue;
+                // Skip missed ticks instead of running several in one frame
+                entry.nextTick += entry.period;
+                if (entry.nextTick <= elapsed) entry.nextTick = elapsed + entry.period;
+            }
+
+            PROFILE_ZONE(entry.system->getName());
+            entry.system->update(entry.accumulated);
+            entry.accumulated = 0;
+        }
+
+        // Resume long running jobs with whatever budget is left for them
+        if (slicer.size()) {
+            PROFILE_ZONE("SystemManager::slicedTasks");
+            slicer.run(taskBudget);
         }
     }
 
+    // Add a job that is resumed every frame until it returns true, within the task budget
+    SlicedTaskID addSlicedTask(SlicedTask task) { return slicer.add(std::move(task)); }
+
+    bool cancelSlicedTask(SlicedTaskID id) { return slicer.cancel(id); }
+
+    // Microseconds per frame spent on sliced tasks
+    void setTaskBudget(uint32_t microseconds) { taskBudget = microseconds; }
+
 private:
     // Helper to reorder systems after adding/removing
     void reorderSystems() {
-        std::sort(systemExecutionOrder.begin(), systemExecutionOrder.end(),
-                [](const std::shared_ptr<ISystem>& a, const std::shared_ptr<ISystem>& b) {
-                    return a->getPriority() < b->getPriority();
+        std::stable_sort(systemExecutionOrder.begin(), systemExecutionOrder.end(),
+                [](const SystemEntry& a, const SystemEntry& b) {
+                    return a.system->getPriority() < b.system->getPriority();
                 });
     }
+
+    // Enable or disable a system for the current state, calling its activation callbacks
+    void updateActivation(SystemEntry& entry) {
+        bool active = (entry.stateMask & STATE_BIT(state)) != 0;
+        if (active == entry.active) return;
+
+        entry.active = active;
+        if (active) {
+            // Start ticking from the activation, time spent disabled doesn't count
+            entry.accumulated = 0;
+            entry.nextTick = elapsed + entry.phase * entry.period;
+            entry.system->onActivate();
+        } else {
+            entry.system->onDeactivate();
+        }
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <vector>
+#include <cstdint>
+#include "Event.h"
+
+// Handle to a scheduled timer, lower 20 bits are the pool index and upper 12 bits the generation
+using TimerID = uint32_t;
+
+constexpr TimerID INVALID_TIMER = 0xFFFFFFFF;
+
+// Hierarchical timing wheel (4 levels of 64 slots). Scheduling and cancelling are O(1),
+// advancing only costs work for the slots that are passed and the timers that expire.
+class TimerWheel {
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint64_t MAX_DELTA = (1ull << (SLOT_BITS * LEVELS)) - 1;
+
+    static constexpr uint32_t INDEX_BITS = 20;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+
+    struct Timer {
+        Event event;
+        uint64_t expires = 0; // absolute tick
+        uint64_t period = 0;  // ticks between repeats, 0 for one-shot
+        uint32_t generation = 0;
+        int32_t prev = -1, next = -1;
+        int16_t level = -1, slot = -1; // level -1 means the timer is not in the wheel
+    };
+
+    float tickLength;
+    float accumulator = 0.0f;
+    uint64_t currentTick = 0;
+    size_t activeTimers = 0;
+
+    std::vector<Timer> timers; // timer pool, indexed by TimerID
+    std::vector<uint32_t> freeList;
+    int32_t slots[LEVELS][SLOTS];
+
+public:
+    // tickLength is the timer resolution in seconds
+    TimerWheel(float tickLength = 0.001f);
+
+    // Schedule an event 'delay' seconds from now, repeating every 'period' seconds if period > 0
+    TimerID schedule(const Event& event, float delay, float period = 0.0f);
+
+    // Cancel a timer, returns false if it has already fired or been cancelled
+    bool cancel(TimerID id);
+
+    // Advance the wheel by deltaTime and append every event that became due to 'due'
+    void advance(float deltaTime, std::vector<Event>& due);
+
+    bool isScheduled(TimerID id) const;
+
+    size_t size() const { return activeTimers; }
+
+    float getTickLength() const { return tickLength; }
+
+private:
+    uint64_t toTicks(float seconds) const;
+
+    void insert(uint32_t index);
+
+    void unlink(uint32_t index);
+
+    // Move every timer in a higher level slot down to where it now belongs
+    void cascade(int level);
+
+    void release(uint32_t index);
+};
+
+#endif
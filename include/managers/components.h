@@ -9,8 +9,12 @@
 #include "graphics/Shader.h"
 #include "graphics/Texture.h"
 #include "EntityManager.h"
+#include "physics/CollisionLayers.h"
 #include "functional"
 
+class Heightfield;
+class TriangleMesh;
+
 struct Material {
     std::shared_ptr<Shape> shape;
     std::shared_ptr<Texture> texture;
@@ -45,11 +49,32 @@ struct Physics {
     Vec3 acceleration;  
     float mass;        
     bool isStatic = false; // True for immovable objects
+    bool isSleeping = false; // Resting, skipped until woken by a contact or PhysicsSystem::wake
+    float sleepTimer = 0;   // Seconds the body has been resting
+    Vec3 restPosition;      // Where it started resting
+    float lodTime = 0;      // Seconds not yet simulated, bodies far from the camera skip steps
+    int lodBand = 0;        // Distance band it was simulated in last
 
     Physics(Vec3 velocity = 0, Vec3 acceleration = 0, float mass = 0, bool isStatic = false)
         : velocity(velocity), acceleration(acceleration), mass(std::max(0.0f, mass)), isStatic(isStatic) {}
 };
 
+// Optional, entities with a Transform collide as unit boxes on COLLISION_LAYER_DEFAULT without it.
+// Layers only filter scene queries, bodies still collide with everything. With a heightfield the
+// entity is static terrain, with a triangle mesh static level geometry, either placed at its position
+// without rotation or scale. They are read when the component is added, remove and add it again to
+// change them.
+struct Collider {
+    uint32_t layers;
+    std::shared_ptr<Heightfield> heightfield; // both null for a unit box
+    std::shared_ptr<TriangleMesh> mesh;
+
+    Collider(uint32_t layers = COLLISION_LAYER_DEFAULT, std::shared_ptr<Heightfield> heightfield = nullptr)
+        : layers(layers), heightfield(std::move(heightfield)) {}
+
+    Collider(uint32_t layers, std::shared_ptr<TriangleMesh> mesh) : layers(layers), mesh(std::move(mesh)) {}
+};
+
 struct LightSource {
     Vec3 color;
     float intensity;
@@ -75,6 +100,7 @@ struct AI {
 #define PHYSICS_MASK        (1 << 2)
 #define LIGHT_SOURCE_MASK   (1 << 3)
 #define AI_MASK             (1 << 4)
+#define COLLIDER_MASK       (1 << 5)
 
 
 const std::unordered_map<std::type_index, uint32_t> COMPONENT_MASKS = {
@@ -83,6 +109,7 @@ const std::unordered_map<std::type_index, uint32_t> COMPONENT_MASKS = {
     { std::type_index(typeid(Physics)), PHYSICS_MASK },
     { std::type_index(typeid(LightSource)), LIGHT_SOURCE_MASK },
     { std::type_index(typeid(AI)), AI_MASK },
+    { std::type_index(typeid(Collider)), COLLIDER_MASK },
 };
 
 #endif
\ No newline at end of file
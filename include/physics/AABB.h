@@ -0,0 +1,84 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include <algorithm>
+#include <cmath>
+#include "linalg/linalg.h"
+
+// Axis aligned bounding box
+struct AABB {
+    Vec3 min;
+    Vec3 max;
+
+    AABB(Vec3 min = { 0,0,0 }, Vec3 max = { 0,0,0 }) : min(min), max(max) {}
+};
+
+inline Vec3 minVec(const Vec3& a, const Vec3& b) {
+    return { std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z) };
+}
+
+inline Vec3 maxVec(const Vec3& a, const Vec3& b) {
+    return { std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z) };
+}
+
+inline bool overlaps(const AABB& a, const AABB& b) {
+    return (a.min.x <= b.max.x && a.max.x >= b.min.x) &&
+           (a.min.y <= b.max.y && a.max.y >= b.min.y) &&
+           (a.min.z <= b.max.z && a.max.z >= b.min.z);
+}
+
+inline bool contains(const AABB& box, const Vec3& point) {
+    return (point.x >= box.min.x && point.x <= box.max.x) &&
+           (point.y >= box.min.y && point.y <= box.max.y) &&
+           (point.z >= box.min.z && point.z <= box.max.z);
+}
+
+// True if 'inner' lies completely inside 'outer'
+inline bool contains(const AABB& outer, const AABB& inner) {
+    return (inner.min.x >= outer.min.x && inner.max.x <= outer.max.x) &&
+           (inner.min.y >= outer.min.y && inner.max.y <= outer.max.y) &&
+           (inner.min.z >= outer.min.z && inner.max.z <= outer.max.z);
+}
+
+inline AABB merge(const AABB& a, const AABB& b) {
+    return { minVec(a.min, b.min), maxVec(a.max, b.max) };
+}
+
+inline AABB expand(const AABB& box, float margin) {
+    Vec3 m(margin, margin, margin);
+    return { box.min - m, box.max + m };
+}
+
+inline float surfaceArea(const AABB& box) {
+    Vec3 d = box.max - box.min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+// Box covering the straight path from 'from' to 'to'
+inline AABB segmentBounds(const Vec3& from, const Vec3& to) {
+    return { minVec(from, to), maxVec(from, to) };
+}
+
+// Slab test of the ray segment origin + direction * t, t in [0, maxT], against a box.
+// Takes 1 / direction, division by zero gives infinities which the test handles.
+inline bool rayOverlaps(const AABB& box, const Vec3& origin, const Vec3& inverseDirection, float maxT) {
+    const float boxMin[3] = { box.min.x, box.min.y, box.min.z };
+    const float boxMax[3] = { box.max.x, box.max.y, box.max.z };
+    const float start[3] = { origin.x, origin.y, origin.z };
+    const float inverse[3] = { inverseDirection.x, inverseDirection.y, inverseDirection.z };
+
+    float tMin = 0.0f, tMax = maxT;
+    for (int axis = 0; axis < 3; axis++) {
+        float t1 = (boxMin[axis] - start[axis]) * inverse[axis];
+        float t2 = (boxMax[axis] - start[axis]) * inverse[axis];
+        // NaN means the ray runs along a slab plane, which doesn't constrain t
+        if (std::isnan(t1) || std::isnan(t2)) continue;
+
+        tMin = std::max(tMin, std::min(t1, t2));
+        tMax = std::min(tMax, std::max(t1, t2));
+        if (tMin > tMax) return false;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef AABBBATCH_H
+#define AABBBATCH_H
+
+#include <vector>
+#include <cstdint>
+#include "physics/AABB.h"
+
+// Boxes stored as structure of arrays so kernels can test 4 (SSE) or 8 (AVX2) at once.
+// Storage is padded to a multiple of BATCH_WIDTH, padding lanes never report a hit.
+struct AABBBatch {
+    static constexpr size_t BATCH_WIDTH = 8;
+
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+    size_t count = 0;
+
+    void clear();
+
+    void add(const AABB& box);
+
+    AABB get(size_t index) const;
+
+    size_t size() const { return count; }
+
+    // Number of boxes including padding, always a multiple of BATCH_WIDTH
+    size_t paddedSize() const { return minX.size(); }
+
+    // Number of hit mask bytes the kernels write, one bit per box
+    size_t maskSize() const { return paddedSize() / 8; }
+};
+
+enum SimdLevel {
+    SIMD_SCALAR,
+    SIMD_SSE,
+    SIMD_AVX2,
+};
+
+// Best instruction set the CPU supports, detected on first use
+SimdLevel getSupportedSimdLevel();
+
+// Instruction set the kernels currently use
+SimdLevel getSimdLevel();
+
+// Force a lower instruction set (for testing and comparisons), clamped to what the CPU supports
+void setSimdLevel(SimdLevel level);
+
+const char* getSimdLevelName(SimdLevel level);
+
+// Batch kernels. Results are bitmasks, bit (i % 8) of masks[i / 8] is set if box i was hit,
+// 'masks' must hold batch.maskSize() bytes.
+
+// Boxes overlapping 'box' (closed intervals, like overlaps())
+void overlapBatch(const AABBBatch& batch, const AABB& box, uint8_t* masks);
+
+// Boxes containing 'point' (closed, like contains())
+void containsPointBatch(const AABBBatch& batch, const Vec3& point, uint8_t* masks);
+
+// Boxes hit by the ray origin + direction * t with an entry before maxT and an exit at t >= 0.
+// tEntry must hold batch.paddedSize() floats and receives the entry time of every box that was hit,
+// which is negative if the ray starts inside.
+void rayBatch(const AABBBatch& batch, const Vec3& origin, const Vec3& direction, float maxT,
+              float* tEntry, uint8_t* masks);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef BODYSTORE_H
+#define BODYSTORE_H
+
+#include <vector>
+#include <cstdint>
+#include "linalg/linalg.h"
+#include "managers/EntityManager.h"
+
+// Bodies stored as structure of arrays so integration runs 4 (SSE) or 8 (AVX2) bodies at once.
+// Storage is padded to a multiple of BATCH_WIDTH with zeros, which integrate to zero.
+struct BodyStore {
+    static constexpr size_t BATCH_WIDTH = 8;
+
+    enum Flags : uint8_t {
+        BODY_TOUCHED = 1 << 0,    // hit another collider this step, stored in contacts
+        BODY_SIMPLIFIED = 1 << 1, // far from the camera, collides by swept moves only and gets no contacts
+    };
+
+    std::vector<Entity> entities;
+    std::vector<float> px, py, pz;
+    std::vector<float> vx, vy, vz;
+    std::vector<float> ax, ay, az;
+    std::vector<float> inverseMass; // massless bodies count as unit mass
+    std::vector<float> deltaTime;   // seconds the body steps, longer for bodies that skipped steps
+    std::vector<uint8_t> flags;
+    std::vector<Entity> contacts;
+    size_t count = 0;
+
+    // Make room for 'bodies' bodies, contents are undefined until set
+    void resize(size_t bodies);
+
+    size_t size() const { return count; }
+
+    // Number of bodies including padding, always a multiple of BATCH_WIDTH
+    size_t paddedSize() const { return px.size(); }
+
+    Vec3 getPosition(size_t i) const { return Vec3(px[i], py[i], pz[i]); }
+    Vec3 getVelocity(size_t i) const { return Vec3(vx[i], vy[i], vz[i]); }
+    Vec3 getAcceleration(size_t i) const { return Vec3(ax[i], ay[i], az[i]); }
+
+    void setPosition(size_t i, const Vec3& p) { px[i] = p.x; py[i] = p.y; pz[i] = p.z; }
+    void setVelocity(size_t i, const Vec3& v) { vx[i] = v.x; vy[i] = v.y; vz[i] = v.z; }
+    void setAcceleration(size_t i, const Vec3& a) { ax[i] = a.x; ay[i] = a.y; az[i] = a.z; }
+};
+
+// Semi-implicit Euler for bodies [begin, end) over their own deltaTime: velocity += acceleration * dt, then
+// position += velocity * dt. 'begin' must be a multiple of BATCH_WIDTH so ranges can be split between threads.
+// Uses the instruction set chosen with setSimdLevel, every level gives the same results.
+void integrateBodies(BodyStore& store, size_t begin, size_t end);
+
+// The two halves of integrateBodies, for changing velocities in between (e.g. solving contacts)
+void integrateVelocities(BodyStore& store, size_t begin, size_t end);
+
+void integratePositions(BodyStore& store, size_t begin, size_t end);
+
+#endif
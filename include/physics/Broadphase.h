@@ -0,0 +1,45 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <vector>
+#include <memory>
+#include "physics/AABB.h"
+#include "physics/CollisionLayers.h"
+#include "managers/EntityManager.h"
+
+enum BroadphaseType {
+    BROADPHASE_SPATIAL_HASH, // uniform grid, best for many objects of similar size
+    BROADPHASE_AABB_TREE,    // dynamic BVH, handles objects of very different sizes
+};
+
+// Spatial acceleration structure the PhysicsSystem uses to find collision candidates
+class IBroadphase {
+public:
+    virtual ~IBroadphase() = default;
+
+    // Add an entity, or move it if it is already in the structure. New entities are on COLLISION_LAYER_DEFAULT.
+    virtual void update(Entity entity, const AABB& bounds) = 0;
+
+    // Change the layers of an entity already in the structure
+    virtual void setLayers(Entity entity, uint32_t layers) = 0;
+
+    virtual void remove(Entity entity) = 0;
+
+    virtual bool contains(Entity entity) = 0;
+
+    // Append every entity on a layer in 'layerMask' whose bounds may overlap 'bounds' to 'result', each at most once.
+    // Queries don't modify the structure and may run on several threads at once between updates.
+    virtual void query(const AABB& bounds, std::vector<Entity>& result, uint32_t layerMask = COLLISION_LAYER_ALL) const = 0;
+
+    // Same for bounds the segment origin + direction * t, t in [0, maxT], may pass through
+    virtual void raycast(const Vec3& origin, const Vec3& direction, float maxT, std::vector<Entity>& result,
+                         uint32_t layerMask = COLLISION_LAYER_ALL) const = 0;
+
+    virtual size_t size() = 0;
+
+    virtual void clear() = 0;
+};
+
+std::unique_ptr<IBroadphase> createBroadphase(BroadphaseType type);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef COLLISIONLAYERS_H
+#define COLLISIONLAYERS_H
+
+// Collision layers. A collider is on one or more layers (bits) and scene queries
+// skip colliders that share no bit with their layer mask.
+#define COLLISION_LAYER_DEFAULT (1u << 0)
+#define COLLISION_LAYER_ALL     0xFFFFFFFFu
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef CONTACTSOLVER_H
+#define CONTACTSOLVER_H
+
+#include <cstdint>
+#include <cstddef>
+#include "physics/BodyStore.h"
+
+// A body's position touching, or about to touch, a box or terrain. Bodies don't rotate, so one point per
+// pair is a complete manifold. Normals are axis aligned against boxes and follow the slope on terrain.
+struct Contact {
+    uint32_t bodyA;           // store index of the body whose position touches the box
+    int32_t bodyB = -1;       // store index of the body owning the box, -1 if it doesn't move this step
+    uint64_t key;             // (entity A << 32) | entity B, identifies the contact across steps
+    Vec3 normal;              // from the box or terrain towards body A
+    float separation;         // gap along the normal at the start of the step, negative when penetrating
+
+    // Accumulated impulses, carried over from the previous step to warm start the solver
+    float normalImpulse = 0;
+    float tangentImpulse[2] = { 0, 0 };
+
+    // Filled in by prepareContacts
+    Vec3 tangent[2];
+    float mass = 0;           // effective mass, the same along every axis without rotation
+    float targetVelocity = 0; // lowest relative velocity along the normal the solver allows
+};
+
+struct ContactSettings {
+    int iterations = 8;                  // upper bound per island
+    float tolerance = 1e-3f;             // an island is done once no impulse changes by more than this
+    float friction = 0.5f;
+    float restitution = 0.8f;            // same bounce as the old reflection
+    float restitutionThreshold = 1.0f;   // slower impacts don't bounce, so resting contacts stay quiet
+    float restOffset = 1e-3f;            // gap bodies settle at, keeps them clear of the closed box bounds
+    float baumgarte = 0.2f;              // share of a penetration removed per step
+    float maxPushVelocity = 2.0f;        // cap on the velocity used to push bodies apart
+};
+
+// Compute masses, tangents and target velocities from the current velocities and body A's deltaTime, then
+// apply the accumulated impulses. Contacts must all belong to bodies that no other thread is solving.
+void prepareContacts(BodyStore& store, Contact* contacts, size_t count, const ContactSettings& settings);
+
+// Sequential impulses over the contacts, returns the number of iterations it took
+int solveContacts(BodyStore& store, Contact* contacts, size_t count, const ContactSettings& settings);
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef DYNAMICAABBTREE_H
+#define DYNAMICAABBTREE_H
+
+#include <unordered_map>
+#include <cstdint>
+#include "physics/Broadphase.h"
+
+// Dynamic bounding volume hierarchy. Leaves store fat boxes (the real bounds grown by a
+// margin) so small movements don't touch the tree, and AVL style rotations keep it balanced
+// as entities are inserted and removed. Queries cost O(log n) independent of object size,
+// which suits scenes mixing large meshes and small cubes better than a uniform grid.
+class DynamicAABBTree : public IBroadphase {
+    static constexpr int32_t NULL_NODE = -1;
+
+    struct Node {
+        AABB bounds;        // fat bounds for leaves, union of the children otherwise
+        Entity entity = 0;
+        int32_t parent = NULL_NODE; // also links free nodes together
+        int32_t left = NULL_NODE;
+        int32_t right = NULL_NODE;
+        int32_t height = -1;        // 0 for leaves, -1 for free nodes
+        uint32_t layers = COLLISION_LAYER_DEFAULT; // union of the children's layers for inner nodes
+
+        bool isLeaf() const { return left == NULL_NODE; }
+    };
+
+    float margin;
+
+    // Node pool, freed nodes are chained through 'parent' and reused before growing
+    std::vector<Node> nodes;
+    int32_t freeList = NULL_NODE;
+
+    int32_t root = NULL_NODE;
+    std::unordered_map<Entity, int32_t> leaves; // entity -> leaf node
+
+public:
+    DynamicAABBTree(float margin = 0.1f) : margin(margin) {}
+
+    void update(Entity entity, const AABB& bounds) override;
+
+    void remove(Entity entity) override;
+
+    bool contains(Entity entity) override { return leaves.count(entity) != 0; }
+
+    void setLayers(Entity entity, uint32_t layers) override;
+
+    // Subtrees without a layer in the mask are skipped as a whole
+    void query(const AABB& bounds, std::vector<Entity>& result, uint32_t layerMask = COLLISION_LAYER_ALL) const override;
+
+    // Tests fat bounds, like query
+    void raycast(const Vec3& origin, const Vec3& direction, float maxT, std::vector<Entity>& result,
+                 uint32_t layerMask = COLLISION_LAYER_ALL) const override;
+
+    size_t size() override { return leaves.size(); }
+
+    void clear() override;
+
+    // Height of the root, 0 for a single leaf and -1 when empty
+    int getHeight() const { return root == NULL_NODE ? -1 : nodes[root].height; }
+
+    // Fat bounds stored for an entity
+    const AABB& getFatBounds(Entity entity) { return nodes[leaves.at(entity)].bounds; }
+
+    // Check parent links, heights and bounds of the whole tree
+    bool validate() const;
+
+private:
+    int32_t allocateNode();
+
+    void freeNode(int32_t node);
+
+    void insertLeaf(int32_t leaf);
+
+    void removeLeaf(int32_t leaf);
+
+    // Rotate the subtree at 'node' if it is unbalanced, returns the new subtree root
+    int32_t balance(int32_t node);
+
+    // Recompute bounds and heights from 'node' up to the root, rebalancing on the way
+    void refit(int32_t node);
+
+    bool validate(int32_t node) const;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef HEIGHTFIELD_H
+#define HEIGHTFIELD_H
+
+#include <vector>
+#include <cstdint>
+#include "linalg/linalg.h"
+#include "physics/AABB.h"
+
+struct HeightfieldHit {
+    float t = 0.0f; // ray parameter of the hit, 0 if the ray started below the surface
+    Vec3 point;
+    Vec3 normal;    // surface normal at the hit
+};
+
+// Terrain surface as heights on a regular grid in the xz plane, solid below the surface.
+// Sample (x, z) lies at origin + (x, 0, z) * cellSize and each cell is split into two triangles
+// along its (0, 0)-(1, 1) diagonal. The cell under a point is found with one division, and rays
+// skip empty space with pyramids of the lowest and highest height over blocks of 2^level cells.
+class Heightfield {
+    Vec3 origin;         // position of sample (0, 0) at height 0
+    float cellSize = 1.0f;
+    int width = 0;       // samples along x
+    int depth = 0;       // samples along z
+    std::vector<float> heights; // row by row along x, origin.y included
+
+    // Level 0 has one entry per cell, every level above halves both sides, the last one is a single block
+    struct Level {
+        int width, depth;
+        std::vector<float> minHeights, maxHeights;
+    };
+    std::vector<Level> levels;
+
+public:
+    Heightfield() = default;
+
+    // 'heights' holds width * depth samples, row by row along x
+    Heightfield(int width, int depth, float cellSize, const Vec3& origin, std::vector<float> heights);
+
+    // Surface of a triangle mesh. Vertices on a regular grid are copied as they are, any other mesh
+    // is sampled from above every 'cellSize', keeping the top surface. Samples no triangle covers
+    // get the mesh's lowest height.
+    Heightfield(const std::vector<Vec3>& positions, const std::vector<uint32_t>& triangles, float cellSize);
+
+    // Surface of a terrain OBJ file, as above. Empty if the file can't be read.
+    Heightfield(const char* objFile, float cellSize);
+
+    bool empty() const { return width < 2 || depth < 2; }
+
+    int getWidth() const { return width; }
+    int getDepth() const { return depth; }
+    float getCellSize() const { return cellSize; }
+
+    float getSample(int x, int z) const { return heights[(size_t)z * width + x]; }
+
+    // Bounds of the surface, the field is solid below it all the way down
+    AABB getBounds() const;
+
+    // Height and normal of the surface above or below (x, z), false outside the field
+    bool getHeight(float x, float z, float& height, Vec3* normal = nullptr) const;
+
+    // Highest point of the surface over the part of the rectangle inside the field, false if it misses the field
+    bool getMaxHeight(float minX, float minZ, float maxX, float maxZ, float& height, Vec3* point = nullptr) const;
+
+    // First point where origin + direction * t, t in [0, maxT], meets the surface
+    bool raycast(const Vec3& origin, const Vec3& direction, float maxT, HeightfieldHit& hit) const;
+
+    // First point where a box moved along origin + direction * t meets the surface. hit.point is the
+    // box's min corner then. The box is stepped by half a cell and the hit refined by bisection,
+    // so it may graze a peak narrower than that.
+    bool sweep(const AABB& box, const Vec3& direction, float maxT, HeightfieldHit& hit) const;
+
+    // True if the box or sphere reaches below the surface
+    bool overlaps(const AABB& box) const;
+
+    bool overlaps(const Vec3& center, float radius) const;
+
+private:
+    void buildLevels();
+
+    // Height and normal in cell (x, z) at fractions (u, v) across it
+    float cellHeight(int x, int z, float u, float v, Vec3* normal) const;
+
+    bool raycastNode(int level, int x, int z, const Vec3& start, const Vec3& direction, float tMin, float tMax,
+                     HeightfieldHit& hit) const;
+
+    bool raycastCell(int x, int z, const Vec3& start, const Vec3& direction, float tMin, float tMax,
+                     HeightfieldHit& hit) const;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef PHYSICSLOD_H
+#define PHYSICSLOD_H
+
+#include <vector>
+#include <cstdint>
+#include "linalg/linalg.h"
+
+// Bodies at least 'distance' from the camera step once every 'interval' steps, covering the skipped
+// time in one longer step. Simplified bodies get no contacts and only bounce off what they hit.
+struct PhysicsLODBand {
+    float distance;
+    int interval;
+    bool simplified;
+};
+
+// Band for a body at 'distance' that was in band 'current'. Bands are sorted by distance and a body
+// only crosses a boundary once it is more than 'hysteresis' (a fraction of the boundary's distance)
+// past it, so bodies near a boundary don't flip between bands every step.
+int selectLODBand(const std::vector<PhysicsLODBand>& bands, float distance, int current, float hysteresis);
+
+// Which of the 'interval' steps a body at 'position' takes. Bodies in the same region of the world
+// share a phase so piles step together, different regions are spread over the steps.
+uint32_t lodPhase(const Vec3& position, int interval);
+
+#endif
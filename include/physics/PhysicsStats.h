@@ -0,0 +1,81 @@
+#ifndef PHYSICSSTATS_H
+#define PHYSICSSTATS_H
+
+#include <cstdint>
+#include <vector>
+#include <ostream>
+
+// Counters and timings of one PhysicsSystem step
+struct PhysicsStats {
+    uint64_t step = 0;
+
+    // Bodies and colliders
+    uint32_t awakeBodies = 0;     // bodies simulated
+    uint32_t steppedBodies = 0;   // awake bodies that took this step, far ones skip some
+    uint32_t simplifiedBodies = 0; // awake bodies far enough to collide without contacts
+    uint32_t sleepingBodies = 0;
+    uint32_t colliders = 0;       // broadphase entries
+    uint32_t staticCubes = 0;     // voxel grid entries
+
+    // Collision work
+    uint64_t moves = 0;                // straight moves tested, one per body plus extra sub-steps
+    uint64_t broadphaseCandidates = 0; // entries the broadphase returned to moves and contact searches, including the body itself
+    uint64_t narrowphaseTests = 0;     // boxes tested against a move or for a contact
+    uint32_t substeppedBodies = 0;     // bodies split into sub-steps by CCD
+    uint32_t collisions = 0;           // moves that ended in a bounce
+    uint32_t bodyContacts = 0;         // contacts pushing on another body, these link islands
+
+    // Contact solver
+    uint32_t solverContacts = 0;
+    uint32_t solverIslands = 0;        // groups of bodies solved together
+    uint32_t solverIterations = 0;     // most iterations any island needed
+
+    // Milliseconds per phase
+    double syncMs = 0;
+    double integrateMs = 0;
+    double solveMs = 0;
+    double collideMs = 0;
+    double writeBackMs = 0;
+    double contactsMs = 0;
+    double islandsMs = 0;
+    double totalMs = 0;
+
+    // Add the collision work counters of 'other', used to merge per thread counts
+    void addWork(const PhysicsStats& other) {
+        moves += other.moves;
+        broadphaseCandidates += other.broadphaseCandidates;
+        narrowphaseTests += other.narrowphaseTests;
+        substeppedBodies += other.substeppedBodies;
+        collisions += other.collisions;
+    }
+
+    // Merge a later step into these totals: counters and timings are summed, while sizes and
+    // solverIterations keep the largest value seen so they still mean the same thing
+    void accumulate(const PhysicsStats& other) {
+        addWork(other);
+        step = other.step > step ? other.step : step;
+        awakeBodies += other.awakeBodies;
+        steppedBodies += other.steppedBodies;
+        simplifiedBodies += other.simplifiedBodies;
+        sleepingBodies += other.sleepingBodies;
+        colliders = other.colliders > colliders ? other.colliders : colliders;
+        staticCubes = other.staticCubes > staticCubes ? other.staticCubes : staticCubes;
+        bodyContacts += other.bodyContacts;
+        solverContacts += other.solverContacts;
+        solverIslands += other.solverIslands;
+        solverIterations = other.solverIterations > solverIterations ? other.solverIterations : solverIterations;
+        syncMs += other.syncMs;
+        integrateMs += other.integrateMs;
+        solveMs += other.solveMs;
+        collideMs += other.collideMs;
+        writeBackMs += other.writeBackMs;
+        contactsMs += other.contactsMs;
+        islandsMs += other.islandsMs;
+        totalMs += other.totalMs;
+    }
+};
+
+// Write steps as CSV with a header line, one step per row
+void writeStatsCSV(std::ostream& out, const std::vector<PhysicsStats>& steps);
+
+#endif
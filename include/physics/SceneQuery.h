@@ -0,0 +1,45 @@
+#ifndef SCENEQUERY_H
+#define SCENEQUERY_H
+
+#include <cstdint>
+#include "physics/AABB.h"
+#include "physics/CollisionLayers.h"
+#include "managers/EntityManager.h"
+
+// Queries for PhysicsSystem's batched raycast, sweep and overlap functions
+
+struct RayQuery {
+    Vec3 origin;
+    Vec3 direction; // doesn't need to be normalised
+    float maxDistance;
+    uint32_t layerMask = COLLISION_LAYER_ALL;
+};
+
+// A box moved along a direction, stopping at the first collider it touches
+struct SweepQuery {
+    AABB box;
+    Vec3 direction;
+    float maxDistance;
+    uint32_t layerMask = COLLISION_LAYER_ALL;
+};
+
+struct BoxQuery {
+    AABB box;
+    uint32_t layerMask = COLLISION_LAYER_ALL;
+};
+
+struct SphereQuery {
+    Vec3 center;
+    float radius;
+    uint32_t layerMask = COLLISION_LAYER_ALL;
+};
+
+struct QueryHit {
+    bool hit = false;
+    Entity entity = 0;
+    float distance = 0;  // along the normalised direction, 0 if the query started inside the collider
+    Vec3 point;          // ray position, or the swept box's min corner, at the hit
+    Vec3 normal;         // face of the collider that was hit
+};
+
+#endif
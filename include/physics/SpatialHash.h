@@ -0,0 +1,69 @@
+#ifndef SPATIALHASH_H
+#define SPATIALHASH_H
+
+#include <unordered_map>
+#include <cstdint>
+#include "physics/Broadphase.h"
+
+// Uniform grid broadphase. Entities are stored in every cell their bounds touch and
+// queries only look at the cells the query box touches, so the cost depends on local
+// density instead of the size of the world.
+class SpatialHash : public IBroadphase {
+    struct CellRange {
+        int minX, minY, minZ;
+        int maxX, maxY, maxZ;
+
+        bool operator==(const CellRange& other) const {
+            return minX == other.minX && minY == other.minY && minZ == other.minZ &&
+                   maxX == other.maxX && maxY == other.maxY && maxZ == other.maxZ;
+        }
+    };
+
+    struct Proxy {
+        Entity entity;
+        AABB bounds;
+        CellRange cells;
+        uint32_t layers = COLLISION_LAYER_DEFAULT;
+    };
+
+    float cellSize;
+    float inverseCellSize;
+
+    std::vector<Proxy> proxies;
+    std::unordered_map<Entity, uint32_t> proxyIndices; // entity -> index in proxies
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells; // cell key -> proxy indices
+
+public:
+    SpatialHash(float cellSize = 2.0f) : cellSize(cellSize), inverseCellSize(1.0f / cellSize) {}
+
+    void update(Entity entity, const AABB& bounds) override;
+
+    void remove(Entity entity) override;
+
+    bool contains(Entity entity) override { return proxyIndices.count(entity) != 0; }
+
+    void setLayers(Entity entity, uint32_t layers) override;
+
+    void query(const AABB& bounds, std::vector<Entity>& result, uint32_t layerMask = COLLISION_LAYER_ALL) const override;
+
+    // Walks the cells along the segment
+    void raycast(const Vec3& origin, const Vec3& direction, float maxT, std::vector<Entity>& result,
+                 uint32_t layerMask = COLLISION_LAYER_ALL) const override;
+
+    size_t size() override { return proxies.size(); }
+
+    void clear() override;
+
+    float getCellSize() { return cellSize; }
+
+private:
+    CellRange getCellRange(const AABB& bounds) const;
+
+    static uint64_t cellKey(int x, int y, int z);
+
+    void addToCells(uint32_t proxy, const CellRange& range);
+
+    void removeFromCells(uint32_t proxy, const CellRange& range);
+};
+
+#endif
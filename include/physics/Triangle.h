@@ -0,0 +1,22 @@
+#ifndef TRIANGLE_H
+#define TRIANGLE_H
+
+#include "linalg/linalg.h"
+#include "physics/AABB.h"
+
+// Tests against single triangles, shared by the heightfield and triangle mesh colliders
+
+// Closest point to p on triangle abc
+Vec3 closestPointOnTriangle(const Vec3& p, const Vec3& a, const Vec3& b, const Vec3& c);
+
+// Two-sided ray test of origin + direction * t, t in (0, maxT], against triangle abc
+bool rayTriangle(const Vec3& origin, const Vec3& direction, float maxT, const Vec3& a, const Vec3& b, const Vec3& c,
+                 float& t);
+
+// First time in [0, 1] a box moving by 'move' touches triangle abc, by the separating axis test on the
+// box's axes, the triangle's normal and their 9 cross products. 'normal' is the axis it touches along,
+// facing the box, and a box that starts out touching gets t = 0. With no move this is an overlap test.
+bool sweepBoxTriangle(const AABB& box, const Vec3& move, const Vec3& a, const Vec3& b, const Vec3& c,
+                      float& t, Vec3& normal);
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef TRIANGLEMESH_H
+#define TRIANGLEMESH_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "linalg/linalg.h"
+#include "physics/AABB.h"
+#include "graphics/Shape.h"
+
+struct MeshHit {
+    float t = 0.0f;        // ray or sweep parameter of the hit, distance for closestPoint
+    Vec3 point;
+    Vec3 normal;           // facing the query
+    uint32_t triangle = 0; // index into the mesh's triangles in BVH order
+};
+
+// Static triangle soup with a bounding volume hierarchy for collision. The vertices are read in
+// place from the Shape it was built from, only the triangles' vertex indices are copied, sorted
+// into BVH order. Triangles are two-sided surfaces, a closed mesh is not solid inside.
+//
+// The BVH is built top down with a binned surface area heuristic, so building takes a few
+// milliseconds even for the larger models and can run on a loader thread.
+class TriangleMesh {
+public:
+    // 32 bytes, two nodes per cache line. Children are stored next to each other.
+    struct Node {
+        Vec3 min;
+        uint32_t first; // first triangle of a leaf, left child of an inner node, the right one is first + 1
+        Vec3 max;
+        uint32_t count; // triangles in a leaf, 0 for an inner node
+    };
+
+private:
+    std::shared_ptr<Shape> shape;  // owner of the vertices, null if they are in 'positions'
+    std::vector<Vec3> positions;
+    const uint8_t* vertexData = nullptr;
+    size_t vertexStride = 0;
+
+    std::vector<uint32_t> triangles; // three vertex indices per triangle
+    std::vector<Node> nodes;         // nodes[0] is the root
+
+public:
+    // Triangles of a loaded shape, which must stay unchanged while the mesh uses it
+    explicit TriangleMesh(std::shared_ptr<Shape> shape);
+
+    // Triangles over vertices the mesh keeps itself, three indices per triangle
+    TriangleMesh(std::vector<Vec3> positions, const std::vector<uint32_t>& indices);
+
+    // vertexData may point into 'positions', a copy would read the original's vertices
+    TriangleMesh(const TriangleMesh&) = delete;
+    TriangleMesh& operator=(const TriangleMesh&) = delete;
+
+    size_t getTriangleCount() const { return triangles.size() / 3; }
+
+    const std::vector<Node>& getNodes() const { return nodes; }
+
+    AABB getBounds() const { return nodes.empty() ? AABB() : AABB(nodes[0].min, nodes[0].max); }
+
+    void getTriangle(uint32_t triangle, Vec3& a, Vec3& b, Vec3& c) const {
+        a = vertex(triangles[triangle * 3]);
+        b = vertex(triangles[triangle * 3 + 1]);
+        c = vertex(triangles[triangle * 3 + 2]);
+    }
+
+    // Nearest triangle along origin + direction * t, t in (0, maxT]
+    bool raycast(const Vec3& origin, const Vec3& direction, float maxT, MeshHit& hit) const;
+
+    // First triangle a box moving along origin + direction * t, t in [0, maxT], touches. hit.point is
+    // the box's min corner then.
+    bool sweep(const AABB& box, const Vec3& direction, float maxT, MeshHit& hit) const;
+
+    // Closest point on the mesh within maxDistance of p, hit.t is its distance
+    bool closestPoint(const Vec3& p, float maxDistance, MeshHit& hit) const;
+
+    // Append the triangles overlapping the box to 'result'
+    void query(const AABB& box, std::vector<uint32_t>& result) const;
+
+    bool overlaps(const AABB& box) const;
+
+    bool overlaps(const Vec3& center, float radius) const;
+
+private:
+    Vec3 vertex(uint32_t index) const { return *(const Vec3*)(vertexData + index * vertexStride); }
+
+    void build();
+};
+
+#endif
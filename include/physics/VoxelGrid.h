@@ -0,0 +1,67 @@
+#ifndef VOXELGRID_H
+#define VOXELGRID_H
+
+#include <unordered_map>
+#include <cstdint>
+#include "linalg/linalg.h"
+#include "managers/EntityManager.h"
+
+// Result of a voxel raycast
+struct VoxelHit {
+    int x = 0, y = 0, z = 0; // cell that was hit
+    Vec3 normal;             // face of the cell that was entered, zero if the ray started inside
+    float t = 0.0f;          // ray parameter of the hit, origin + direction * t
+    Entity entity = 0;       // entity occupying the cell
+};
+
+// Occupancy of unit cubes on integer coordinates, cell (x, y, z) covers [x, x+1] on every axis.
+// Cells are stored as one bit each in 16x16x16 chunks so checking a cell is a single lookup,
+// and rays walk the cells they pass through (Amanatides-Woo) instead of testing every cube.
+class VoxelGrid {
+    static constexpr int CHUNK_BITS = 4;
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_BITS;
+    static constexpr int CHUNK_MASK = CHUNK_SIZE - 1;
+    static constexpr int CHUNK_WORDS = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE / 64;
+
+    struct Chunk {
+        uint64_t bits[CHUNK_WORDS] = {};
+        uint32_t count = 0; // occupied cells
+    };
+
+    std::unordered_map<uint64_t, Chunk> chunks;
+    std::unordered_map<uint64_t, Entity> owners; // cell key -> entity, for picking
+    size_t cellCount = 0;
+
+public:
+    // Mark a cell as occupied by an entity, replacing any previous owner
+    void set(int x, int y, int z, Entity entity);
+
+    void erase(int x, int y, int z);
+
+    bool isSolid(int x, int y, int z) const;
+
+    // Entity occupying a cell, only valid if the cell is solid
+    Entity getEntity(int x, int y, int z) const;
+
+    // Walk the cells along origin + direction * t for t in [0, maxT] and report the first solid
+    // one. With skipStart the cell containing the origin is ignored, for bodies resting on a face.
+    bool raycast(const Vec3& origin, const Vec3& direction, float maxT, VoxelHit& hit, bool skipStart = false) const;
+
+    size_t size() const { return cellCount; }
+
+    void clear();
+
+    // Cell of a position if it lies on integer coordinates
+    static bool toCell(const Vec3& position, int& x, int& y, int& z);
+
+private:
+    static uint64_t chunkKey(int x, int y, int z);
+
+    static uint64_t cellKey(int x, int y, int z);
+
+    static int bitIndex(int x, int y, int z) {
+        return (x & CHUNK_MASK) | ((y & CHUNK_MASK) << CHUNK_BITS) | ((z & CHUNK_MASK) << (2 * CHUNK_BITS));
+    }
+};
+
+#endif
@@ -8,11 +8,29 @@ protected:
     uint32_t requiredComponents = 0; // Bitmask defining components this system requires
 
 public:
+    virtual ~ISystem() = default;
+
     virtual int getPriority() = 0;
 
+    // Readable name used by the profiler and benchmarks
+    virtual const char* getName() = 0;
+
     virtual void processEvent(const Event& event, float deltaTime) = 0;
 
+    // update receives the time since the system's last tick
     virtual void update(float deltaTime) = 0;
+
+    // Tick rate in Hz, 0 ticks every frame
+    virtual float getTickRate() { return 0; }
+
+    // Offset of the first tick as a fraction [0, 1) of the tick period.
+    // Negative lets the SystemManager spread systems with the same rate over different frames.
+    virtual float getTickPhase() { return -1; }
+
+    // Called when the game state enables or disables the system, must stay cheap
+    virtual void onActivate() {}
+
+    virtual void onDeactivate() {}
 };
 
 #endif
\ No newline at end of file
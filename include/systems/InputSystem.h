@@ -22,6 +22,8 @@ public:
         : window(window), camera(camera) {}
 
     int getPriority() override { return 1; }
+
+    const char* getName() override { return "InputSystem"; }
     
     void processEvent(const Event& event, float deltaTime) override;
 
@@ -0,0 +1,36 @@
+#ifndef NULLRENDERSYSTEM_H
+#define NULLRENDERSYSTEM_H
+
+#include "ISystem.h"
+#include "managers/Registry.h"
+#include "graphics/RenderScene.h"
+
+// Render backend for headless runs. It keeps the same instance slots as RenderSystem and
+// writes the changed ones, so the CPU side of rendering is still exercised, but never touches GL.
+class NullRenderSystem : public ISystem {
+private:
+    RenderScene scene;
+    std::vector<InstanceData> instances; // reused across frames
+    std::vector<TextureUpload> textureUploads;
+
+    size_t instanceCount = 0;
+
+public:
+    NullRenderSystem() {}
+
+    int getPriority() override { return 3; }
+
+    const char* getName() override { return "NullRenderSystem"; }
+
+    void processEvent(const Event& event, float deltaTime) override;
+
+    void update(float deltaTime) override;
+
+    // Number of instances written in the last frame, only the changed ones
+    size_t getInstanceCount() { return instanceCount; }
+
+    // Number of instances drawn every frame
+    size_t getSlotCount() { return scene.getSlotCount(); }
+};
+
+#endif
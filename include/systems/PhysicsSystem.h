@@ -2,6 +2,17 @@
 #define PHYSICSSYSTEM_H
 
 #include "managers/Registry.h"
+#include "physics/Broadphase.h"
+#include "physics/VoxelGrid.h"
+#include "physics/Heightfield.h"
+#include "physics/TriangleMesh.h"
+#include "physics/AABBBatch.h"
+#include "physics/BodyStore.h"
+#include "physics/ContactSolver.h"
+#include "physics/SceneQuery.h"
+#include "physics/PhysicsStats.h"
+#include "physics/PhysicsLOD.h"
+#include "graphics/Camera.h"
 #include "ISystem.h"
 
 class PhysicsSystem : public ISystem {
@@ -10,29 +21,274 @@ class PhysicsSystem : public ISystem {
 
     Registry& registry = Registry::getInstance();
 
-    std::vector<Entity> entities;
+    std::vector<Entity> awakeBodies; // bodies simulated each step, sleeping and static ones cost nothing
+    std::vector<Entity> steppedBodies; // awake bodies taking this step, far ones skip some
+    std::vector<Entity> woken; // woken since the step started, simulated from the next one
+    uint64_t registryVersion = UINT64_MAX;
+
+    // Where each entity with a transform went at the last sync. Only entities the registry lists as
+    // structurally changed are placed again.
+    enum PlacementKind {
+        PLACED_COLLIDER, // in the broadphase
+        PLACED_CUBE,     // in the voxel grid
+        PLACED_TERRAIN,
+        PLACED_MESH,
+    };
+    struct Placement {
+        PlacementKind kind;
+        AABB bounds; // when it was placed
+        bool moving;  // a body that isn't static, nothing sleeps on it for long
+    };
+    std::unordered_map<Entity, Placement> placements;
+    size_t colliderCount = 0;
+    size_t cubeCount = 0;
+    std::vector<Entity> structureChanges; // sync scratch
+    std::vector<AABB> removedBounds; // of static placements taken out, sleeping bodies around them wake up
+    std::vector<Entity> nearby; // sync scratch
+
+    // Broadphase over every collider. Colliders without Physics are treated as static and
+    // are only resynchronised when entities or components are added or removed.
+    std::unique_ptr<IBroadphase> broadphase;
+
+    // Awake bodies, gathered from their components at the start of a step and written back at the end.
+    // Every body is stepped in parallel from the state at the start of the step, so the result
+    // doesn't depend on how the bodies were split between threads.
+    BodyStore store;
+
+    unsigned maxThreads = 0; // 0 uses every thread of the pool
+
+    // Level of detail by distance from the camera, off without a camera
+    std::shared_ptr<Camera> lodCamera;
+    std::vector<PhysicsLODBand> lodBands = { { 0.0f, 1, false }, { 48.0f, 2, false }, { 128.0f, 4, true } };
+    float lodHysteresis = 0.1f;
+
+    // Contacts of this step, found in parallel per range of bodies and solved per island.
+    // Accumulated impulses persist between steps per contact key to warm start the solver.
+    struct Manifold {
+        Vec3 normal;
+        float normalImpulse;
+        float tangentImpulse[2];
+    };
+    ContactSettings contactSettings;
+    float contactMargin = 0.05f; // resting contacts are kept while the gap stays below this
+    std::vector<std::vector<Contact>> rangeContacts;
+    std::vector<Contact> solverContacts;
+    std::unordered_map<uint64_t, Manifold> manifolds;
+    std::unordered_map<Entity, uint32_t> storeIndex; // awake body -> index in the store
+    std::vector<uint32_t> solverParents;
+    std::vector<uint32_t> solverIslandStarts; // ranges of solverContacts, one per island
+
+    // Bodies moving further than this in one step are sub-stepped, up to maxSubsteps times
+    float maxStepDistance = 0.5f;
+    int maxSubsteps = 8;
+
+    // Static cubes on integer coordinates, kept out of the broadphase
+    VoxelGrid voxels;
+
+    // Entities with a heightfield Collider, also kept out of the broadphase. They never move.
+    struct Terrain {
+        Entity entity;
+        std::shared_ptr<Heightfield> field;
+        Vec3 offset; // the entity's position
+        uint32_t layers;
+    };
+    std::vector<Terrain> terrains;
+
+    // Entities with a triangle mesh Collider, kept the same way
+    struct StaticMesh {
+        Entity entity;
+        std::shared_ptr<TriangleMesh> mesh;
+        Vec3 offset; // the entity's position
+        uint32_t layers;
+    };
+    std::vector<StaticMesh> meshes;
+
+    // Bodies that rested together fall asleep together and are woken as a group
+    std::vector<std::vector<Entity>> islands;
+    std::vector<uint32_t> freeIslands;
+    std::unordered_map<Entity, uint32_t> islandOf; // sleeping body -> island
+
+    // Recent contacts between awake bodies, keyed by entity pair, value is seconds since they last touched.
+    // Resting bodies only touch now and then, so contacts are kept for timeToSleep to hold stacks together.
+    std::unordered_map<uint64_t, float> contacts;
+    std::unordered_map<Entity, uint32_t> bodyIndex; // island building scratch
+    std::vector<uint32_t> islandParents;
+
+    float sleepDistance = 0.05f; // bodies that stay this close to one spot are resting
+    float timeToSleep = 0.5f;    // seconds a whole island must rest before it sleeps
 
     float gravity = -9.816f;
 
+    PhysicsStats stats; // last step
+    std::vector<PhysicsStats> statsLog; // ring buffer of recent steps, empty when logging is off
+    size_t statsLogHead = 0;
+    size_t statsLogged = 0;
+    uint64_t stepCount = 0;
+
 public:
-    PhysicsSystem() {}
+    PhysicsSystem(BroadphaseType broadphaseType = BROADPHASE_SPATIAL_HASH);
 
     int getPriority() override { return 2; }
 
+    const char* getName() override { return "PhysicsSystem"; }
+
     void processEvent(const Event& event, float deltaTime) override;
 
     void update(float deltaTime) override;
 
+    // Swap the broadphase, it is refilled on the next update
+    void setBroadphase(BroadphaseType type);
+
+    IBroadphase& getBroadphase() { return *broadphase; }
+
+    const VoxelGrid& getVoxels() { return voxels; }
+
+    // Wake a sleeping body together with its island. Call it after moving a body by hand.
+    void wake(Entity entity);
+
+    // Change a body's velocity by impulse / mass and wake it, massless bodies take the impulse as velocity
+    void applyImpulse(Entity entity, const Vec3& impulse);
+
+    // Limit the threads a step runs on, 1 runs it on the calling thread only. Results are the same either way.
+    void setMaxThreads(unsigned threads) { maxThreads = threads; }
+
+    // Bodies far from the camera step less often and more coarsely, see PhysicsLODBand. Pass nullptr
+    // to simulate every body at full rate.
+    void setLODCamera(std::shared_ptr<Camera> camera) { lodCamera = camera; }
+
+    // Bands sorted by distance, the first one should start at 0
+    void setLODBands(const std::vector<PhysicsLODBand>& bands, float hysteresis = 0.1f) {
+        lodBands = bands;
+        lodHysteresis = hysteresis;
+    }
+
+    // Friction, restitution and iteration limits of the contact solver
+    ContactSettings& getContactSettings() { return contactSettings; }
+
+    // A lower maxStepDistance follows fast bodies more closely. Nothing tunnels either way, collisions
+    // are detected along the whole path.
+    void setSubstepping(float distance, int substeps) { maxStepDistance = distance; maxSubsteps = std::max(substeps, 1); }
+
+    // Counters and timings of the last step
+    const PhysicsStats& getStats() { return stats; }
+
+    // Keep the stats of the last 'steps' steps, 0 turns the log off
+    void setStatsLogSize(size_t steps);
+
+    // Logged steps, oldest first
+    std::vector<PhysicsStats> getStatsLog();
+
+    // Write the logged steps as CSV, for tuning against recorded scenes
+    bool exportStatsLog(const char* filepath);
+
+    void setSleepThresholds(float distance, float seconds) { sleepDistance = distance; timeToSleep = seconds; }
+
+    size_t getAwakeCount() { return awakeBodies.size(); }
+
+    size_t getSleepingCount() { return islandOf.size(); }
+
+    // First static cube within maxDistance along a ray, hit.t is the distance along 'direction'
+    bool raycastBlocks(const Vec3& origin, const Vec3& direction, float maxDistance, VoxelHit& hit);
+
+    // Block under the centre of the screen, for selecting or editing blocks
+    bool pickBlock(const Camera& camera, float maxDistance, VoxelHit& hit) {
+        return raycastBlocks(camera.position, camera.getViewDirection(), maxDistance, hit);
+    }
+
+    // Scene queries against every collider, static cubes and bodies alike, on a layer in layerMask.
+    // The batch versions spread their queries over the thread pool and write one result per query.
+
+    // Nearest collider along a ray
+    bool raycast(const Vec3& origin, const Vec3& direction, float maxDistance, QueryHit& hit,
+                 uint32_t layerMask = COLLISION_LAYER_ALL);
+
+    void raycast(const RayQuery* queries, size_t count, QueryHit* hits);
+
+    // First collider a box touches while moving along 'direction'
+    bool sweep(const AABB& box, const Vec3& direction, float maxDistance, QueryHit& hit,
+               uint32_t layerMask = COLLISION_LAYER_ALL);
+
+    void sweep(const SweepQuery* queries, size_t count, QueryHit* hits);
+
+    // Append every collider overlapping the box or sphere to 'result'
+    void overlapBox(const AABB& box, std::vector<Entity>& result, uint32_t layerMask = COLLISION_LAYER_ALL);
+
+    void overlapBox(const BoxQuery* queries, size_t count, std::vector<std::vector<Entity>>& results);
+
+    void overlapSphere(const Vec3& center, float radius, std::vector<Entity>& result,
+                       uint32_t layerMask = COLLISION_LAYER_ALL);
+
+    void overlapSphere(const SphereQuery* queries, size_t count, std::vector<std::vector<Entity>>& results);
+
 private:
+    // Refresh cached entity lists and broadphase proxies
+    void syncBroadphase();
+
+    // Take an entity out of wherever it was placed, and put it where it belongs now
+    void unplace(Entity entity);
+
+    void place(Entity entity);
+
+    // Terrain and meshes, which are never bodies or broadphase colliders
+    bool isStaticGeometry(Entity entity) {
+        if (!registry.match(entity, COLLIDER_MASK)) return false;
+        const Collider& collider = registry.getComponent<Collider>(entity);
+        return collider.heightfield || collider.mesh;
+    }
+
+    uint32_t getLayers(Entity entity) {
+        return registry.match(entity, COLLIDER_MASK) ? registry.getComponent<Collider>(entity).layers : COLLISION_LAYER_DEFAULT;
+    }
+
+    // Query implementations, they expect synced structures and only read them so they can run in parallel
+    void castRay(const RayQuery& query, QueryHit& hit);
+
+    void castBox(const SweepQuery& query, QueryHit& hit);
+
+    // Colliders overlapping 'bounds', and the sphere too if radius >= 0
+    void findOverlaps(const AABB& bounds, const Vec3& center, float radius, uint32_t layerMask, std::vector<Entity>& result);
+
+    // Append the static cubes overlapping 'bounds' to 'boxes', with their min corner moved back by 'grow', and 'owners'
+    void gatherCubes(const AABB& bounds, const Vec3& grow, AABBBatch& boxes, std::vector<Entity>& owners);
+
+    void wakeIsland(uint32_t island);
+
+    // Wake the islands of sleeping bodies touching 'bounds'
+    void wakeTouching(const AABB& bounds);
+
+    // Append the contacts of a body's position with every box within contactMargin of it or on its way.
+    // 'reach' is how far other bodies may move towards it this step.
+    void findContacts(size_t body, float reach, std::vector<Contact>& result, PhysicsStats& work);
+
+    // Find, solve and remember this step's contacts, changes the velocities in the store
+    void resolveContacts(PhysicsStats& current);
+
+    // Pick the awake bodies taking this step and add the time they cover to their lodTime
+    void selectSteppedBodies(float deltaTime, uint64_t step, PhysicsStats& current);
+
+    // Collide an integrated body with the world as it was at the start of the step, writes nothing but
+    // the body's entry in the store. Bodies taking this step are left to the contact solver, unless
+    // this one is simplified.
+    void collideBody(size_t body, PhysicsStats& work);
+
+    // Stop a straight move from 'from' to 'to' at the earliest collision along it and bounce
+    void moveBody(size_t body, const Vec3& from, Vec3& to, Vec3& velocity, Vec3& acceleration, PhysicsStats& work);
+
+    // Group awake bodies by contact and put islands that have rested long enough to sleep
+    void updateIslands(float deltaTime);
+
+    static uint64_t contactKey(Entity a, Entity b) {
+        return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+    }
+
+    // Every entity collides as a unit box at its position
+    static AABB getBounds(const Vec3& position) { return { position, position + Vec3(1,1,1) }; }
+
     // Detects if and when a point and direction is going to hit an AABB
-    bool rayDetectionAABB(const Vec3& point, const Vec3& direction, const Vec3& AABBmin, const Vec3& AABBmax, 
+    static bool rayDetectionAABB(const Vec3& point, const Vec3& direction, const Vec3& AABBmin, const Vec3& AABBmax, 
                                 Vec3& collisionNormal, float& tEntry, float& tExit); // return values
-    
-    bool overlapDetectionAABB(const Vec3& min1, const Vec3& max1, const Vec3& min2, const Vec3& max2);
-
-    bool PointInAABB(const Vec3& point, const Vec3& AABBmin, const Vec3& AABBmax);
 
-    Vec3 calculateRebound(const Vec3& velocity, const Vec3& normal, float bounceFactor);
+    static Vec3 calculateRebound(const Vec3& velocity, const Vec3& normal, float bounceFactor);
 };
 
-#endif
\ No newline at end of file
+#endif
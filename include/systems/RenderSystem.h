@@ -3,6 +3,12 @@
 
 #include <bits/stdc++.h>
 #include "graphics/Camera.h"
+#include "graphics/FramePacket.h"
+#include "graphics/RenderThread.h"
+#include "graphics/InstanceRing.h"
+#include "graphics/InstanceBuffer.h"
+#include "graphics/RenderScene.h"
+#include "graphics/TextureArrays.h"
 #include "ISystem.h"
 #include "managers/ResourceManager.h"
 #include "managers/Registry.h"
@@ -11,39 +17,58 @@
 
 class RenderSystem : public ISystem {
 private:
-    uint32_t requiredComponents = MATERIAL_MASK | TRANSFORM_MASK;
-    
     SDL_Window* window;
     std::shared_ptr<Camera> camera;
     
     Registry& registry = Registry::getInstance();
     ResourceManager& resourceManager = ResourceManager::getInstance();
     
-    std::vector<Entity> entities;
+    // Instance slots kept between frames (simulation side)
+    RenderScene scene;
+
+    // Single threaded mode prepares and submits this packet every frame
+    FramePacket packet;
+
+    // Only touched where the GL context is current. New instance data of the last three frames is
+    // uploaded through the ring, and copied from there into the slots of each batch's buffer.
+    // Textures stay in their array layer from their first frame on.
+    InstanceRing instanceRing;
+    std::vector<InstanceBuffer> instanceBuffers; // by batch
+    TextureArrays textureArrays;
+
+    // Pipelined mode hands packets to a render thread that owns the GL context
+    std::unique_ptr<RenderThread> renderThread;
 
 public:
-    RenderSystem(SDL_Window* window, std::shared_ptr<Camera> camera)
-        : window(window), camera(camera) {}
+    // Passing the GL context enables pipelined mode, the context moves to a dedicated render thread
+    RenderSystem(SDL_Window* window, std::shared_ptr<Camera> camera, SDL_GLContext pipelineContext = nullptr);
+
+    ~RenderSystem();
         
     int getPriority() override { return 3; }
 
+    const char* getName() override { return "RenderSystem"; }
+
     void processEvent(const Event& event, float deltaTime) override;
 
     void update(float deltaTime) override;
 
 private:
-    // Distribute entities across different shaders and render them
-    void renderEntities();
+    // Snapshot camera, lights and per-shape instance data from the registry (simulation side)
+    void preparePacket(FramePacket& packet);
+
+    // Draw a prepared packet and swap buffers (GL side)
+    void submitPacket(const FramePacket& packet);
 
     // Gets the 'amount' most meaningful light sources
-    std::vector<LightData> getLightSources(size_t amount);
+    void getLightSources(size_t amount, std::vector<LightData>& lights);
 
-    // Render multiple instances of the same shape, using a texture array
-    void renderInstancesArray(std::vector<Entity> entities);
+    // Render multiple instances of the same shape, one draw per texture array they use
+    void renderInstancesArray(const DrawBatch& batch, const InstanceBuffer& instances, const FramePacket& packet);
 
     // Render multiple instances of the same shape, using a texture atlas
-    void renderInstancesAtlas(std::vector<Entity> entities);
+    void renderInstancesAtlas(const DrawBatch& batch, const FramePacket& packet);
 };
 
 
-#endif
\ No newline at end of file
+#endif
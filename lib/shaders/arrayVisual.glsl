@@ -19,18 +19,24 @@ out uint Shininess;
 out float Reflectivity;
 
 uniform mat4 matCamera;
+uniform uint textureArrayIndex;
 
 void main() {
     // Calculate the models projected position
     gl_Position = matCamera * matWorld * vec4(position, 1.0);
 
+    // Instances textured from another array are drawn by another call, collapse them here
+    if ((texIndex >> 16) != textureArrayIndex) {
+        gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+    }
+
     // Transform normal and frag position to world space
     FragPos = vec3(matWorld * vec4(position, 1.0));
     Normal = vec3(transpose(inverse(matWorld)) * vec4(normal, 0.0));
 
     // Transfer texture data
     textureCoord = texCoord;
-    textureIndex = texIndex;
+    textureIndex = texIndex & 0xFFFFu;
 
     Shininess = shininess;
     Reflectivity = reflectivity;
@@ -58,6 +64,7 @@ uniform float globalAmbience;
 uniform vec3 directionalLightDir;
 uniform vec3 directionalLightColor;
 uniform sampler2DArray textureArray;
+uniform uint textureArrayIndex; // 0xFFFF for instances without a texture
 
 flat in uint textureIndex;
 flat in uint Shininess;
@@ -94,7 +101,10 @@ vec3 calculateLight(Light light, vec3 normal, vec3 pos, vec3 eyeDir) {
 
 void main() {
     // Texture color
-    vec3 textureColor = vec3(texture(textureArray, vec3(textureCoord, textureIndex)));
+    vec3 textureColor = vec3(1.0);
+    if (textureArrayIndex != 0xFFFFu) {
+        textureColor = vec3(texture(textureArray, vec3(textureCoord, textureIndex)));
+    }
     
     // Directional variables
     vec3 normal = normalize(Normal);
@@ -4,6 +4,7 @@
 #include <unistd.h>
 #include <limits>
 #include <memory>
+#include <string>
 #include <SDL2/SDL.h>
 #include <glad/glad.h>
 #include "linalg/linalg.h"
@@ -11,6 +12,7 @@
 #include "managers/SystemManager.h"
 #include "managers/ResourceManager.h"
 #include "managers/Registry.h"
+#include "core/FramePacer.h"
 
 // Window dimensions
 int WINDOW_SIZE = 600;
@@ -65,19 +67,64 @@ bool initializeWindow(SDL_Window** window, SDL_GLContext* context) {
     return true;
 }
 
+// Headless mode runs the simulation without a window or GL context
+bool initializeHeadless() {
+    // Only timers and events, SDL still turns SIGINT into a quit event
+    if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) != 0) {
+        std::cerr << "Error initializing SDL: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    // Resources are parsed but never uploaded
+    ResourceManager::getInstance().setHeadless(true);
+
+    std::cout << "Running headless" << std::endl;
+    return true;
+}
+
 int main(int argc, char* argv[]) {
+    // Command line options
+    bool headless = false;
+    long maxFrames = -1; // run until quit
+    double targetFps = 0; // unlimited
+    double menuFps = 30;
+    bool pipelined = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--frames" && i + 1 < argc) {
+            maxFrames = std::atol(argv[++i]);
+        } else if (arg == "--pipelined") {
+            pipelined = true;
+        } else if (arg == "--fps" && i + 1 < argc) {
+            targetFps = std::atof(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [--headless] [--pipelined] [--frames N] [--fps N]" << std::endl;
+            return -1;
+        }
+    }
+
     // Global instances
     SDL_Window* window = nullptr;
-    SDL_GLContext glContext;
-
-    // Initialize SDL and OpenGL
-    if (!initializeWindow(&window, &glContext)) {
-        std::cerr << "Error initializing window " << SDL_GetError() << std::endl;
-        return -1;
-    }    
-
-    SDL_ShowCursor(SDL_DISABLE);
-    SDL_SetRelativeMouseMode(SDL_TRUE);
+    SDL_GLContext glContext = nullptr;
+
+    if (headless) {
+        if (!initializeHeadless()) return -1;
+    } else {
+        // Initialize SDL and OpenGL
+        if (!initializeWindow(&window, &glContext)) {
+            std::cerr << "Error initializing window " << SDL_GetError() << std::endl;
+            return -1;
+        }    
+
+        SDL_ShowCursor(SDL_DISABLE);
+        SDL_SetRelativeMouseMode(SDL_TRUE);
+
+        // The frame pacer limits the rate instead of vsync
+        if (targetFps > 0) SDL_GL_SetSwapInterval(0);
+    }
 
     std::shared_ptr camera = std::make_shared<Camera>(
         Vec3(0.0f, 2.0f, 0.0f),  // Position
@@ -156,45 +203,44 @@ int main(int argc, char* argv[]) {
     registry.addComponent<LightSource>(entity, light);
     registry.addComponent<Transform>(entity, transform);
     */
-    float lastFrameTime = SDL_GetTicks() / 1000.0f;
-    GameState currentState = NONE;
-    while (currentState != QUIT) {
-        float currentTime = SDL_GetTicks() / 1000.0f;
-        float deltaTime = currentTime - lastFrameTime;
-        lastFrameTime = currentTime;
-        // Check for state switching and update systems accordingly
-        if (currentState != SM.getState()) {
-            currentState = SM.getState();
-            SM.clearSystems();
-            switch (currentState) {
-            case QUIT:
-                break;
-            case INGAME:
-                SM.registerSystem<InputSystem>(window, camera);
-                SM.registerSystem<RenderSystem>(window, camera);
-                SM.registerSystem<PhysicsSystem>();
-                break;
-            case MAINMENU:
-                SM.registerSystem<InputSystem>(window, camera);
-                SM.registerSystem<RenderSystem>(window, camera);
-                break;
-            case PAUSEMENU:
-                SM.registerSystem<InputSystem>(window, camera);
-                SM.registerSystem<RenderSystem>(window, camera);
-                break;
-            default:
-                break;
-            }
+    // Register every system once, game states only enable or disable them
+    if (headless) {
+        SM.registerSystem<PhysicsSystem>();
+        SM.registerSystem<NullRenderSystem>();
+    } else {
+        SM.registerSystem<InputSystem>(window, camera);
+        // Pipelined rendering moves the GL context to a render thread, so every
+        // GPU resource has to be loaded before this point
+        SM.registerSystem<RenderSystem>(window, camera, pipelined ? glContext : nullptr);
+        // Bodies far from the player are simulated at a lower rate
+        SM.registerSystem<PhysicsSystem>()->setLODCamera(camera);
+    }
+    SM.setSystemStates<PhysicsSystem>(STATE_BIT(INGAME));
+
+    FramePacer pacer(targetFps);
+    GameState pacedState = NONE;
+    long frame = 0;
+    while (SM.getState() != QUIT && (maxFrames < 0 || frame++ < maxFrames)) {
+        // Menus don't need a high frame rate, so don't burn the CPU on them
+        if (pacedState != SM.getState()) {
+            pacedState = SM.getState();
+            pacer.setTargetRate(pacedState == INGAME ? targetFps : menuFps);
         }
+        float deltaTime = pacer.beginFrame();
 
         // process and update this frame
         SM.processEvents(deltaTime);
         SM.update(deltaTime);
     }
 
-    // Cleanup
-    SDL_GL_DeleteContext(glContext);
-    SDL_DestroyWindow(window);
+    FrameStats stats = pacer.getStats();
+    std::cout << "Frame time (ms) mean: " << stats.mean << " p50: " << stats.p50 << " p99: " << stats.p99
+              << " max: " << stats.max << " jitter: " << stats.jitter << std::endl;
+
+    // Cleanup, systems (and the render thread) go before the context they use
+    SM.clearSystems();
+    if (glContext) SDL_GL_DeleteContext(glContext);
+    if (window) SDL_DestroyWindow(window);
     SDL_Quit();
 
     return 0;
@@ -0,0 +1,91 @@
+#include "core/FramePacer.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <time.h>
+#include <errno.h>
+
+FramePacer::FramePacer(double targetRate, double spinThreshold)
+    : frequency(SDL_GetPerformanceFrequency()), spinThreshold(spinThreshold) {
+    frameStart = now();
+    setTargetRate(targetRate);
+}
+
+uint64_t FramePacer::now() const {
+    return SDL_GetPerformanceCounter();
+}
+
+void FramePacer::setTargetRate(double rate) {
+    targetRate = std::max(0.0, rate);
+    deadline = frameStart + (targetRate > 0 ? (uint64_t)(frequency / targetRate) : 0);
+}
+
+float FramePacer::beginFrame() {
+    if (targetRate > 0) {
+        waitUntil(deadline);
+    }
+
+    uint64_t current = now();
+    double frameMs = (current - frameStart) * 1000.0 / frequency;
+    frameStart = current;
+    record(frameMs);
+
+    if (targetRate > 0) {
+        uint64_t period = (uint64_t)(frequency / targetRate);
+        // Keep a fixed cadence, but don't try to catch up after a long hitch
+        deadline = (deadline + period > current) ? deadline + period : current + period;
+    }
+
+    return frameMs / 1000.0;
+}
+
+void FramePacer::waitUntil(uint64_t target) {
+    uint64_t spinTicks = (uint64_t)(spinThreshold * frequency);
+
+    // Coarse sleep, the scheduler may oversleep so leave the last part for spinning
+    uint64_t current = now();
+    if (target > current + spinTicks) {
+        double sleepSeconds = (double)(target - current - spinTicks) / frequency;
+        timespec ts;
+        ts.tv_sec = (time_t)sleepSeconds;
+        ts.tv_nsec = (long)((sleepSeconds - ts.tv_sec) * 1e9);
+        while (clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts) == EINTR) {}
+    }
+
+    // Fine spin on the performance counter
+    while (now() < target) {}
+}
+
+void FramePacer::record(double frameMs) {
+    auto bucket = [](double ms) {
+        return std::min(BUCKETS - 1, (size_t)(ms / BUCKET_MS));
+    };
+
+    size_t slot = frameCount % WINDOW;
+    if (frameCount >= WINDOW) {
+        histogram[bucket(frameTimes[slot])]--;
+    }
+    frameTimes[slot] = frameMs;
+    histogram[bucket(frameMs)]++;
+    frameCount++;
+}
+
+FrameStats FramePacer::getStats() const {
+    FrameStats stats;
+    size_t count = std::min(frameCount, WINDOW);
+    if (count == 0) return stats;
+
+    std::vector<double> sorted(frameTimes.begin(), frameTimes.begin() + count);
+    std::sort(sorted.begin(), sorted.end());
+
+    for (double ms : sorted) stats.mean += ms;
+    stats.mean /= count;
+
+    for (double ms : sorted) stats.jitter += (ms - stats.mean) * (ms - stats.mean);
+    stats.jitter = std::sqrt(stats.jitter / count);
+
+    stats.p50 = sorted[(count - 1) / 2];
+    stats.p99 = sorted[std::min(count - 1, (size_t)(0.99 * (count - 1) + 0.5))];
+    stats.max = sorted.back();
+    return stats;
+}
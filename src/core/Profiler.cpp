@@ -0,0 +1,99 @@
+#include "core/Profiler.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+static thread_local ProfileBuffer* threadBuffer = nullptr;
+
+ProfileBuffer& Profiler::getThreadBuffer() {
+    if (!threadBuffer) {
+        // Buffers are owned by the profiler so zones survive their thread for export
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffers.push_back(std::make_unique<ProfileBuffer>(buffers.size()));
+        threadBuffer = buffers.back().get();
+    }
+    return *threadBuffer;
+}
+
+void Profiler::record(const char* name, uint64_t start, uint64_t end) {
+    ProfileBuffer& buffer = getThreadBuffer();
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    ProfileSlot& slot = buffer.slots[head % ProfileBuffer::CAPACITY];
+
+    // Mark the slot as being written before any of its fields change
+    slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(end - start, std::memory_order_relaxed);
+    slot.sequence.store(2 * head + 2, std::memory_order_release);
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+bool ProfileBuffer::read(uint64_t index, ProfileEvent& event) const {
+    const ProfileSlot& slot = slots[index % CAPACITY];
+    uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * index + 2) return false;
+
+    event.name = slot.name.load(std::memory_order_relaxed);
+    event.start = slot.start.load(std::memory_order_relaxed);
+    event.duration = slot.duration.load(std::memory_order_relaxed);
+
+    // The copy is only good if the writer didn't start on the slot meanwhile
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+static void writeEscaped(std::ofstream& out, const char* str) {
+    for (; *str; str++) {
+        if (*str == '"' || *str == '\\') out << '\\';
+        out << *str;
+    }
+}
+
+bool Profiler::exportChromeTrace(const char* filepath) {
+    std::ofstream out(filepath);
+    if (!out.is_open()) {
+        std::cerr << "Error opening trace file: " << filepath << "\n";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(buffersMutex);
+
+    // Snapshot the buffers while their threads keep recording, events overwritten
+    // during the copy are left out
+    std::vector<std::pair<uint32_t, ProfileEvent>> events;
+    uint64_t origin = UINT64_MAX;
+    for (const auto& buffer : buffers) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = head > ProfileBuffer::CAPACITY ? head - ProfileBuffer::CAPACITY : 0;
+
+        for (uint64_t i = begin; i < head; i++) {
+            ProfileEvent event;
+            if (!buffer->read(i, event) || event.start < startTime) continue;
+            events.push_back({ buffer->threadID, event });
+            origin = std::min(origin, event.start);
+        }
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& [threadID, event] : events) {
+        out << (first ? "" : ",") << "\n{\"name\":\"";
+        writeEscaped(out, event.name);
+        out << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << threadID
+            << ",\"ts\":" << (event.start - origin) / 1000.0
+            << ",\"dur\":" << event.duration / 1000.0 << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+
+    std::cout << "Profile written to " << filepath << std::endl;
+    return true;
+}
+
+void Profiler::clear() {
+    // Zones recorded before the new start time are ignored on export
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    startTime = now();
+}
@@ -0,0 +1,87 @@
+#include "core/ThreadPool.h"
+#include <algorithm>
+
+// Set on threads that are running a loop body, nested loops run inline instead of deadlocking
+static thread_local bool insideLoop = false;
+
+ThreadPool::ThreadPool() {
+    unsigned cores = std::thread::hardware_concurrency();
+    unsigned count = cores > 1 ? cores - 1 : 0; // the caller is the remaining thread
+    for (unsigned i = 0; i < count; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+void ThreadPool::workerLoop() {
+    insideLoop = true;
+    uint64_t seen = 0;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeCondition.wait(lock, [&]() { return stopping || (generation != seen && openSlots > 0); });
+        if (stopping) return;
+
+        seen = generation;
+        openSlots--;
+        activeHelpers++;
+        lock.unlock();
+
+        runChunks();
+
+        lock.lock();
+        if (--activeHelpers == 0) doneCondition.notify_all();
+    }
+}
+
+void ThreadPool::runChunks() {
+    size_t chunk;
+    while ((chunk = nextChunk.fetch_add(1, std::memory_order_relaxed)) < chunkCount) {
+        size_t begin = chunk * jobGrain;
+        (*job)(begin, std::min(begin + jobGrain, jobCount));
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body,
+                             unsigned maxThreads) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+
+    size_t chunks = (count + grain - 1) / grain;
+    unsigned threads = maxThreads ? std::min(maxThreads, getThreadCount()) : getThreadCount();
+    if (insideLoop || chunks == 1 || threads == 1) {
+        for (size_t begin = 0; begin < count; begin += grain) body(begin, std::min(begin + grain, count));
+        return;
+    }
+
+    std::lock_guard<std::mutex> submitLock(submitMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &body;
+        jobCount = count;
+        jobGrain = grain;
+        chunkCount = chunks;
+        nextChunk.store(0, std::memory_order_relaxed);
+        openSlots = (unsigned)std::min<size_t>(threads - 1, chunks - 1);
+        generation++;
+    }
+    wakeCondition.notify_all();
+
+    insideLoop = true;
+    runChunks();
+    insideLoop = false;
+
+    // Every chunk is claimed now, close the loop to latecomers and wait for the ones still running
+    std::unique_lock<std::mutex> lock(mutex);
+    openSlots = 0;
+    doneCondition.wait(lock, [&]() { return activeHelpers == 0; });
+    job = nullptr;
+}
@@ -0,0 +1,41 @@
+#include "core/TimeSlicer.h"
+#include <chrono>
+
+SlicedTaskID TimeSlicer::add(SlicedTask task) {
+    tasks.push_back({ nextID, std::make_shared<SlicedTask>(std::move(task)) });
+    return nextID++;
+}
+
+bool TimeSlicer::cancel(SlicedTaskID id) {
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if (tasks[i].id != id) continue;
+
+        tasks.erase(tasks.begin() + i);
+        if (nextTask > i) nextTask--;
+        return true;
+    }
+    return false;
+}
+
+void TimeSlicer::run(uint32_t budgetMicros) {
+    using Clock = std::chrono::steady_clock;
+    auto deadline = Clock::now() + std::chrono::microseconds(budgetMicros);
+
+    while (!tasks.empty()) {
+        if (nextTask >= tasks.size()) nextTask = 0;
+
+        // Steps may add or cancel tasks, so don't hold on to a reference into the list.
+        // The stored callable itself is called, it keeps its progress between steps.
+        std::shared_ptr<SlicedTask> step = tasks[nextTask].step;
+        SlicedTaskID id = tasks[nextTask].id;
+        bool done = (*step)();
+
+        if (done) {
+            cancel(id);
+        } else if (nextTask < tasks.size() && tasks[nextTask].id == id) {
+            nextTask++;
+        }
+
+        if (Clock::now() >= deadline) break;
+    }
+}
@@ -0,0 +1,34 @@
+#include "graphics/InstanceBuffer.h"
+#include <algorithm>
+#include "core/Profiler.h"
+
+void InstanceBuffer::reserve(size_t count) {
+    if (count <= capacity) return;
+    PROFILE_ZONE("InstanceBuffer::reserve");
+
+    // Grow with headroom, the old slots are copied over on the GPU
+    size_t newCapacity = std::max({ count, capacity + capacity / 2, (size_t)64 });
+    GLuint newBuffer;
+    glGenBuffers(1, &newBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, newCapacity * sizeof(InstanceData), nullptr, 0);
+    if (buffer) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, capacity * sizeof(InstanceData));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    buffer = newBuffer;
+    capacity = newCapacity;
+}
+
+void InstanceBuffer::copy(GLuint source, size_t first, size_t slot, size_t count) {
+    glBindBuffer(GL_COPY_READ_BUFFER, source);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, first * sizeof(InstanceData),
+                        slot * sizeof(InstanceData), count * sizeof(InstanceData));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
@@ -0,0 +1,69 @@
+#include "graphics/InstanceRing.h"
+#include <iostream>
+#include <algorithm>
+#include "core/Profiler.h"
+
+void InstanceRing::waitForRegion(int region) {
+    if (!fences[region]) return;
+
+    // Usually signalled long ago, flush in case it was never sent to the GPU
+    GLenum result = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (result == GL_TIMEOUT_EXPIRED) {
+        PROFILE_ZONE("InstanceRing::wait");
+        result = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+    }
+    if (result == GL_WAIT_FAILED) {
+        std::cerr << "Error waiting for instance buffer fence: " << glGetError() << "\n";
+    }
+    glDeleteSync(fences[region]);
+    fences[region] = nullptr;
+}
+
+void InstanceRing::allocate(size_t capacity) {
+    PROFILE_ZONE("InstanceRing::allocate");
+    release();
+    this->capacity = capacity;
+
+    // Immutable storage, mapped once for as long as the buffer lives
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLsizeiptr size = (GLsizeiptr)(REGIONS * capacity * sizeof(InstanceData));
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+    mapped = (InstanceData*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (!mapped) {
+        std::cerr << "Error mapping instance buffer: " << glGetError() << "\n";
+    }
+}
+
+void InstanceRing::release() {
+    for (int i = 0; i < REGIONS; i++) waitForRegion(i);
+    if (buffer) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+    }
+    buffer = 0;
+    mapped = nullptr;
+    capacity = 0;
+    region = 0;
+}
+
+InstanceData* InstanceRing::beginFrame(size_t count) {
+    // Growing waits for every region, so leave room for the scene to grow a while
+    if (count > capacity || !buffer) {
+        allocate(std::max({ count + count / 2, capacity * 2, (size_t)1024 }));
+    }
+    if (!mapped) return nullptr;
+    waitForRegion(region);
+    return mapped + region * capacity;
+}
+
+void InstanceRing::endFrame() {
+    if (!buffer) return;
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    region = (region + 1) % REGIONS;
+}
@@ -0,0 +1,135 @@
+#include "graphics/RenderScene.h"
+#include <algorithm>
+#include "core/Profiler.h"
+
+// Unchanged slots between two changed ones are uploaded with them if that saves a copy
+static constexpr uint32_t MAX_RUN_GAP = 16;
+
+void RenderScene::update() {
+    PROFILE_ZONE("RenderScene::update");
+    runs.clear();
+    instanceCount = 0;
+
+    // The first update takes everything already in the registry, later ones only what changed
+    registry.takeChanged(changed);
+    if (!synced) {
+        synced = true;
+        std::vector<Entity> all = registry.getEntitiesWith(requiredComponents);
+        changed.insert(changed.end(), all.begin(), all.end());
+    }
+
+    for (Entity entity : changed) {
+        auto it = slotOf.find(entity);
+        bool renderable = registry.isAlive(entity) && registry.match(entity, requiredComponents);
+        if (it == slotOf.end()) {
+            if (renderable) addSlot(entity);
+            continue;
+        }
+        if (!renderable) {
+            removeSlot(entity);
+            continue;
+        }
+
+        // A new shape moves the entity to another batch
+        Batch& batch = batches[it->second.batch];
+        if (registry.getComponent<Material>(entity).shape != batch.shape) {
+            removeSlot(entity);
+            addSlot(entity);
+        } else {
+            batch.dirtySlots.push_back(it->second.slot);
+        }
+    }
+
+    // Changed slots close to each other are uploaded together
+    for (uint32_t b = 0; b < batches.size(); b++) {
+        Batch& batch = batches[b];
+        std::sort(batch.dirtySlots.begin(), batch.dirtySlots.end());
+        auto end = std::unique(batch.dirtySlots.begin(), batch.dirtySlots.end());
+        for (auto slot = batch.dirtySlots.begin(); slot != end && *slot < batch.slots.size(); slot++) {
+            InstanceRun* last = runs.empty() ? nullptr : &runs.back();
+            if (last && last->batch == b && *slot - (last->slot + last->count) <= MAX_RUN_GAP) {
+                uint32_t added = *slot + 1 - (last->slot + last->count);
+                last->count += added;
+                instanceCount += added;
+            } else {
+                runs.push_back({ b, *slot, 1, (uint32_t)instanceCount });
+                instanceCount++;
+            }
+        }
+        batch.dirtySlots.clear();
+    }
+}
+
+void RenderScene::writeInstances(InstanceData* instances) {
+    PROFILE_ZONE("RenderScene::writeInstances");
+    for (const InstanceRun& run : runs) {
+        Batch& batch = batches[run.batch];
+        for (uint32_t i = 0; i < run.count; i++) {
+            // Whole instances only, the memory may be write combined
+            instances[run.first + i] = makeInstance(batch, batch.slots[run.slot + i]);
+        }
+    }
+}
+
+void RenderScene::addSlot(Entity entity) {
+    const Material& material = registry.getComponent<Material>(entity);
+    auto [it, inserted] = batchOf.try_emplace(material.shape.get(), 0);
+    if (inserted) {
+        if (!freeBatches.empty()) {
+            it->second = freeBatches.back();
+            freeBatches.pop_back();
+        } else {
+            it->second = (uint32_t)batches.size();
+            batches.emplace_back();
+        }
+        batches[it->second].shape = material.shape;
+    }
+
+    Batch& batch = batches[it->second];
+    slotOf[entity] = { it->second, (uint32_t)batch.slots.size() };
+    batch.dirtySlots.push_back((uint32_t)batch.slots.size());
+    batch.slots.push_back(entity);
+}
+
+void RenderScene::removeSlot(Entity entity) {
+    auto it = slotOf.find(entity);
+    Slot slot = it->second;
+    slotOf.erase(it);
+
+    // The last slot fills the hole, so only that one is uploaded again
+    Batch& batch = batches[slot.batch];
+    Entity last = batch.slots.back();
+    batch.slots.pop_back();
+    if (slot.slot < batch.slots.size()) {
+        batch.slots[slot.slot] = last;
+        slotOf[last].slot = slot.slot;
+        batch.dirtySlots.push_back(slot.slot);
+    }
+
+    // An empty batch lets go of its shape and is reused for the next new one
+    if (batch.slots.empty()) {
+        batchOf.erase(batch.shape.get());
+        released.push_back(std::move(batch.shape));
+        batch.textureArrays.clear();
+        batch.dirtySlots.clear();
+        freeBatches.push_back(slot.batch);
+    }
+}
+
+InstanceData RenderScene::makeInstance(Batch& batch, Entity entity) {
+    const Material& material = registry.getComponent<Material>(entity);
+    const Transform& transform = registry.getComponent<Transform>(entity);
+
+    InstanceData instance;
+    instance.matWorld = MatrixWorld(transform.position, transform.rotation, transform.scale);
+    instance.reflectivity = material.reflectivity;
+    instance.shininess = material.shininess;
+
+    // The batch is drawn once per texture array, each draw only keeps the instances of its array
+    TextureLayer layer = textureLayers.getLayer(material.texture);
+    if (std::find(batch.textureArrays.begin(), batch.textureArrays.end(), layer.array) == batch.textureArrays.end()) {
+        batch.textureArrays.push_back(layer.array);
+    }
+    instance.textureIndex = layer.pack();
+    return instance;
+}
@@ -0,0 +1,90 @@
+#include "graphics/RenderThread.h"
+#include <iostream>
+
+FramePipeline::FramePipeline() {
+    for (int i = 0; i < SLOTS; i++) {
+        freeSlots.push_back(i);
+    }
+}
+
+FramePacket* FramePipeline::beginWrite() {
+    // Only one finished frame may wait for the render thread, so the simulation stays one frame ahead
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&] { return stopped || (!freeSlots.empty() && readySlots.empty()); });
+    if (stopped) return nullptr;
+
+    writeSlot = freeSlots.back();
+    freeSlots.pop_back();
+    return &packets[writeSlot];
+}
+
+void FramePipeline::endWrite() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (writeSlot == -1) return;
+        readySlots.push_back(writeSlot);
+        writeSlot = -1;
+    }
+    condition.notify_all();
+}
+
+FramePacket* FramePipeline::beginRead() {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&] { return stopped || !readySlots.empty(); });
+    if (stopped) return nullptr;
+
+    readSlot = readySlots.front();
+    readySlots.pop_front();
+    lock.unlock();
+    condition.notify_all(); // the simulation may be waiting for the ready packet to be taken
+    return &packets[readSlot];
+}
+
+void FramePipeline::endRead() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (readSlot == -1) return;
+        freeSlots.push_back(readSlot);
+        readSlot = -1;
+    }
+    condition.notify_all();
+}
+
+void FramePipeline::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+    condition.notify_all();
+}
+
+void RenderThread::start(std::function<void(const FramePacket&)> submit) {
+    if (running) return;
+    running = true;
+
+    // A context can only be current on one thread at a time
+    SDL_GL_MakeCurrent(window, nullptr);
+
+    thread = std::thread([this, submit]() {
+        if (SDL_GL_MakeCurrent(window, context) != 0) {
+            std::cerr << "Error making GL context current on render thread: " << SDL_GetError() << std::endl;
+        }
+
+        while (FramePacket* packet = pipeline.beginRead()) {
+            submit(*packet);
+            packet->released.clear(); // with the context current, for any GL objects they free
+            pipeline.endRead();
+        }
+
+        SDL_GL_MakeCurrent(window, nullptr);
+    });
+}
+
+void RenderThread::stop() {
+    if (!running) return;
+    running = false;
+
+    pipeline.stop();
+    thread.join();
+    SDL_GL_MakeCurrent(window, context);
+}
@@ -23,6 +23,19 @@ void Shader::bindFloat(float f, const char* name) {
 	}
 }
 
+void Shader::bindUInt(GLuint value, const char* name) {
+    GLuint uniformLocation = glGetUniformLocation(programID, name);
+	if (uniformLocation == -1) {
+		std::cerr << "Uniform '" << name << "' not found in shader program" << std::endl;
+	} else {
+		glUniform1ui(uniformLocation, value);
+		GLenum error = glGetError();
+		if (error != GL_NO_ERROR) {
+            std::cerr << "Error while setting uniform '" << name << "': " << glGetError() << std::endl;
+        }
+	}
+}
+
 void Shader::bindVector(Vec3 vector, const char* name) {
     GLuint uniformLocation = glGetUniformLocation(programID, name);
 	if (uniformLocation == -1) {
@@ -50,7 +63,7 @@ void Shader::bindMatrix(Mat4x4 matrix, const char* name) {
 	}
 }
 
-void Shader::bindLights(std::vector<LightData> lights) {
+void Shader::bindLights(const std::vector<LightData>& lights) {
     glUniform1i(glGetUniformLocation(programID, "numLights"), lights.size());
     for (size_t i = 0; i < lights.size(); ++i) {
         std::string lightBase = "lights[" + std::to_string(i) + "]";
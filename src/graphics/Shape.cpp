@@ -6,34 +6,35 @@
 #include <map>
 #include "graphics/Shape.h"
 
-Shape::Shape(const char* shapeFile, bool loadByIndices) {
+Shape::Shape(const char* shapeFile, bool loadByIndices, bool uploadToGPU) : uploadToGPU(uploadToGPU) {
     this->loadFromOBJFile(shapeFile, loadByIndices);
 }
 
 void Shape::cleanup() {
 	vertices.clear();
 	indices.clear();
+
+    // Nothing was uploaded (headless mode or not loaded yet)
+    if (!isOnGPU()) return;
     
     // delete buffers
 	if (VBO) glDeleteBuffers(1, &VBO);
     if (VAO) glDeleteVertexArrays(1, &VAO);
     if (IBO) glDeleteBuffers(1, &IBO);
-    if (instanceVBO) glDeleteBuffers(1, &instanceVBO);
 
     // Unbind buffers
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     
-    VBO = VAO = IBO = instanceVBO = 0;
+    VBO = VAO = IBO = 0;
 }
 
 // Load shape and generate buffers
 void Shape::loadShapeToGPU() {    
-    // Generate and bind Vertex Array Object (VAO) and instanceVBO
+    // Generate and bind Vertex Array Object (VAO)
 	glGenVertexArrays(1, &VAO);
     glBindVertexArray(VAO);
-    glGenBuffers(1, &instanceVBO);    
     
     // Generate and bind Vertex Buffer Object (VBO)
     glGenBuffers(1, &VBO);
@@ -78,14 +79,13 @@ void Shape::drawSingle() {
     }
 }
 
-void Shape::drawInstancesAtlas(std::vector<InstanceData>& instances) {
+void Shape::drawInstancesAtlas(const std::vector<InstanceData>& instances) {
 
 }
 
-void Shape::drawInstancesArray(std::vector<InstanceData>& instances) {
-    // Bind the instance buffer and upload instance data
-    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(InstanceData), instances.data(), GL_STATIC_DRAW);
+void Shape::drawInstancesArray(GLuint instanceBuffer, GLuint baseInstance, GLsizei count) {
+    // Bind the instance buffer, the data is already in it
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
 
     // Enable the texture index as an instance attribute
     glEnableVertexAttribArray(3); 
@@ -109,11 +109,12 @@ void Shape::drawInstancesArray(std::vector<InstanceData>& instances) {
         glVertexAttribDivisor(6 + i, 1);  // Tell OpenGL this attribute should be updated per instance
     }
 
-    // Draw instances
+    // Draw instances, the base instance offsets where the per instance attributes are read from
     if (!indices.empty()) {
-        glDrawElementsInstanced(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT, indices.data(), instances.size());
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT, indices.data(), count,
+                                            baseInstance);
     } else {
-        glDrawArraysInstanced(GL_TRIANGLES, 0, vertices.size(), instances.size());
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, vertices.size(), count, baseInstance);
     }
 
     // Unbind buffer
@@ -129,7 +130,7 @@ void Shape::loadFromOBJFile(std::string filename, bool loadByIndices) {
 	else
 		loadByVertexArray(filename);
     
-    loadShapeToGPU();
+    if (uploadToGPU) loadShapeToGPU();
 }
 
 void Shape::printVericies() {
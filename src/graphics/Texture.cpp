@@ -2,11 +2,10 @@
 #include <SDL2/SDL_image.h>
 #include <iostream>
 #include <vector>
+#include "core/Profiler.h"
 
 // Creates a texture from filepath
-Texture::Texture(const char* filepath) {
-    // Generate textureID
-    glGenTextures(1, &textureID);
+Texture::Texture(const char* filepath, bool uploadToGPU) {
 	// Load image using SDL_image
     SDL_Surface* surface = IMG_Load(filepath);
     if (!surface) {
@@ -23,10 +22,16 @@ Texture::Texture(const char* filepath) {
     this->surface = formattedSurface;
 
     // load texture to GPU so it's ready for rendering.
-    loadTextureToGPU();
+    if (uploadToGPU) loadTextureToGPU();
+}
+
+Texture::Texture(SDL_Surface* surface, bool uploadToGPU) : surface(surface) {
+    if (uploadToGPU) loadTextureToGPU();
 }
 
 void Texture::loadTextureToGPU() {
+    PROFILE_ZONE("Texture::loadTextureToGPU");
+    glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_2D, textureID);
 
     // Set texture parameters (filtering, wrapping)
@@ -44,28 +49,3 @@ void Texture::loadTextureToGPU() {
         std::cerr << "Error during texture upload: " << error << "\n";
     }
 }
-    
-void TextureArray::loadTexturesToGPU() {
-    glBindTexture(GL_TEXTURE_2D_ARRAY, textureArrayID);
-
-    int w = array[0]->surface->w, h = array[0]->surface->h;
-
-    // Allocate storage for the texture array
-    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, w, h, array.size(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-
-    // Upload each texture slice into the array
-    for (int i = 0; i < array.size(); ++i) {
-        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, i, w, h, 1, GL_RGBA, GL_UNSIGNED_BYTE, array[i]->surface->pixels);
-    }
-
-    // Set texture parameters
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    GLenum error = glGetError();
-    if (error != GL_NO_ERROR) {
-        std::cerr << "Error during texture array upload: " << error << "\n";
-    }
-}
\ No newline at end of file
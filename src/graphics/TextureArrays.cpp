@@ -0,0 +1,119 @@
+#include "graphics/TextureArrays.h"
+#include <iostream>
+#include <algorithm>
+#include "core/Profiler.h"
+
+// Texture converts every image to RGBA32, anything else has no array to go in
+static bool hasArrayFormat(const Texture& texture) {
+    return texture.surface && texture.surface->format->format == SDL_PIXELFORMAT_RGBA32;
+}
+
+void TextureLayers::releaseExpired() {
+    for (auto it = residents.begin(); it != residents.end();) {
+        if (it->second.texture.expired()) {
+            it->second.group->freeLayers.push_back(it->second.layer);
+            it = residents.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+TextureLayer TextureLayers::getLayer(const std::shared_ptr<Texture>& texture) {
+    if (!texture || !hasArrayFormat(*texture)) return { NO_ARRAY, 0 };
+
+    // A texture at the address of one that is gone doesn't get its layer
+    auto it = residents.find(texture.get());
+    if (it != residents.end()) {
+        if (!it->second.texture.expired()) return it->second.layer;
+        it->second.group->freeLayers.push_back(it->second.layer);
+        residents.erase(it);
+    }
+
+    const SDL_Surface* surface = texture->surface;
+    Group& group = groups[{ surface->w, surface->h, surface->format->format }];
+
+    // Before adding an array, look for layers of textures that are gone
+    if (group.freeLayers.empty() && (group.arrays.empty() || group.used == ARRAY_LAYERS)) releaseExpired();
+
+    TextureLayer layer;
+    if (!group.freeLayers.empty()) {
+        layer = group.freeLayers.back();
+        group.freeLayers.pop_back();
+    } else {
+        if (group.arrays.empty() || group.used == ARRAY_LAYERS) {
+            if (arrayCount == NO_ARRAY) {
+                std::cerr << "Out of texture arrays\n";
+                return { NO_ARRAY, 0 };
+            }
+            group.arrays.push_back(arrayCount++);
+            group.used = 0;
+        }
+        layer = { group.arrays.back(), group.used++ };
+    }
+
+    residents[texture.get()] = { texture, layer, &group };
+    uploads.push_back({ texture, layer });
+    return layer;
+}
+
+void TextureLayers::takeUploads(std::vector<TextureUpload>& result) {
+    result.insert(result.end(), uploads.begin(), uploads.end());
+    uploads.clear();
+}
+
+TextureArrays::~TextureArrays() {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    for (GLuint array : arrays) {
+        if (array) glDeleteTextures(1, &array);
+    }
+}
+
+void TextureArrays::allocate(uint16_t array, const SDL_Surface* surface) {
+    PROFILE_ZONE("TextureArrays::allocate");
+    if (arrays.size() <= array) arrays.resize(array + 1, 0);
+
+    // Immutable storage for every layer and its whole mip chain
+    GLsizei levels = 1;
+    while ((std::max(surface->w, surface->h) >> levels) > 0) levels++;
+    glGenTextures(1, &arrays[array]);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, arrays[array]);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, surface->w, surface->h, TextureLayers::ARRAY_LAYERS);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void TextureArrays::upload(const std::vector<TextureUpload>& uploads) {
+    if (uploads.empty()) return;
+    PROFILE_ZONE("TextureArrays::upload");
+
+    std::vector<uint16_t> touched;
+    for (const TextureUpload& upload : uploads) {
+        const SDL_Surface* surface = upload.texture->surface;
+        if (!getArray(upload.layer.array)) allocate(upload.layer.array, surface);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, arrays[upload.layer.array]);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, surface->pitch / 4);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, upload.layer.layer, surface->w, surface->h, 1, GL_RGBA,
+                        GL_UNSIGNED_BYTE, surface->pixels);
+        touched.push_back(upload.layer.array);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    // Mips of every array that got a new layer, once for all of them
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (uint16_t array : touched) {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, arrays[array]);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        std::cerr << "Error during texture array upload: " << error << "\n";
+    }
+}
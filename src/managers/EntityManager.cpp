@@ -24,8 +24,9 @@ Entity EntityManager::createEntity() {
 void EntityManager::destroyEntity(Entity entity) {
     // Add the entity to the available IDs queue
     availableIDs.push(entity);
-    // Remove from active entities
+    // Remove from active entities and mask queries
     activeEntities.erase(entity);
+    entityMasks.erase(entity);
 }
 
 bool EntityManager::isEntityAlive(Entity entity) {
@@ -33,7 +34,9 @@ bool EntityManager::isEntityAlive(Entity entity) {
 }
 
 bool EntityManager::match(Entity entity, u_int32_t mask) {
-    return ((entityMasks[entity] | mask) == mask);
+    // Same rule as getEntitiesByMask: the entity has every component in the mask
+    auto it = entityMasks.find(entity);
+    return it != entityMasks.end() && (it->second & mask) == mask;
 }
 
 void EntityManager::addComponentMask(Entity entity, uint32_t mask) {
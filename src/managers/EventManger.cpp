@@ -33,3 +33,19 @@ bool EventManager::poll(Event& event) {
     eventQueue.pop();
     return true;
 }
+
+TimerID EventManager::schedule(const Event& event, float delay, float period) {
+    return timers.schedule(event, delay, period);
+}
+
+bool EventManager::cancel(TimerID timer) {
+    return timers.cancel(timer);
+}
+
+void EventManager::advanceTimers(float deltaTime) {
+    timers.advance(deltaTime, dueEvents);
+    for (const auto& event : dueEvents) {
+        publish(event);
+    }
+    dueEvents.clear();
+}
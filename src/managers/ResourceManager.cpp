@@ -7,7 +7,7 @@ std::shared_ptr<Shape> ResourceManager::getShape(const char* shapeFilepath, bool
     }
     
     // Otherwise, load the shape and store it in the cache
-    std::shared_ptr<Shape> newShape = std::make_shared<Shape>(shapeFilepath, loadByIndices);
+    std::shared_ptr<Shape> newShape = std::make_shared<Shape>(shapeFilepath, loadByIndices, !headless);
     shapeCache[shapeFilepath] = newShape;
     return newShape;
 }
@@ -18,12 +18,16 @@ std::shared_ptr<Texture> ResourceManager::getTexture(const char* textureFilepath
     }
 
     // Otherwise, load the texture and store it in the cache
-    std::shared_ptr<Texture> newTexture = std::make_shared<Texture>(textureFilepath);
+    std::shared_ptr<Texture> newTexture = std::make_shared<Texture>(textureFilepath, !headless);
     textureCache[textureFilepath] = newTexture;
     return newTexture;
 }
 
 std::shared_ptr<Shader> ResourceManager::getShader(const char* shaderFilepath) {
+    if (headless) {
+        throw std::runtime_error("Shaders can't be loaded in headless mode!");
+    }
+
     if (auto cachedShader = shaderCache[shaderFilepath].lock()) {
         return cachedShader;
     }
@@ -33,3 +37,26 @@ std::shared_ptr<Shader> ResourceManager::getShader(const char* shaderFilepath) {
     shaderCache[shaderFilepath] = newShader;
     return newShader;
 }
+
+std::shared_ptr<Heightfield> ResourceManager::getHeightfield(const char* objFilepath, float cellSize) {
+    std::string key = std::string(objFilepath) + "@" + std::to_string(cellSize);
+    if (auto cachedHeightfield = heightfieldCache[key].lock()) {
+        return cachedHeightfield;
+    }
+
+    // Otherwise, sample the mesh and store it in the cache
+    std::shared_ptr<Heightfield> newHeightfield = std::make_shared<Heightfield>(objFilepath, cellSize);
+    heightfieldCache[key] = newHeightfield;
+    return newHeightfield;
+}
+
+std::shared_ptr<TriangleMesh> ResourceManager::getTriangleMesh(const char* shapeFilepath) {
+    if (auto cachedMesh = triangleMeshCache[shapeFilepath].lock()) {
+        return cachedMesh;
+    }
+
+    // Otherwise, build it over the cached shape and store it in the cache
+    std::shared_ptr<TriangleMesh> newMesh = std::make_shared<TriangleMesh>(getShape(shapeFilepath));
+    triangleMeshCache[shapeFilepath] = newMesh;
+    return newMesh;
+}
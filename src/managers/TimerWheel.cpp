@@ -0,0 +1,156 @@
+#include "managers/TimerWheel.h"
+#include <cmath>
+#include <algorithm>
+
+TimerWheel::TimerWheel(float tickLength) : tickLength(tickLength > 0.0f ? tickLength : 0.001f) {
+    for (int level = 0; level < LEVELS; level++) {
+        for (int slot = 0; slot < SLOTS; slot++) {
+            slots[level][slot] = -1;
+        }
+    }
+}
+
+uint64_t TimerWheel::toTicks(float seconds) const {
+    if (seconds <= 0.0f) return 0;
+    return (uint64_t)std::ceil(seconds / tickLength);
+}
+
+TimerID TimerWheel::schedule(const Event& event, float delay, float period) {
+    uint32_t index;
+    if (!freeList.empty()) {
+        index = freeList.back();
+        freeList.pop_back();
+    } else {
+        if (timers.size() > INDEX_MASK) {
+            std::cerr << "Timer pool exhausted!\n";
+            return INVALID_TIMER;
+        }
+        index = timers.size();
+        timers.emplace_back();
+    }
+
+    Timer& timer = timers[index];
+    timer.event = event;
+    // a timer always fires on a later tick than the current one
+    timer.expires = currentTick + std::max<uint64_t>(1, toTicks(delay));
+    timer.period = (period > 0.0f) ? std::max<uint64_t>(1, toTicks(period)) : 0;
+    insert(index);
+    activeTimers++;
+
+    return (timer.generation << INDEX_BITS) | index;
+}
+
+bool TimerWheel::cancel(TimerID id) {
+    if (!isScheduled(id)) return false;
+
+    uint32_t index = id & INDEX_MASK;
+    unlink(index);
+    release(index);
+    return true;
+}
+
+bool TimerWheel::isScheduled(TimerID id) const {
+    uint32_t index = id & INDEX_MASK;
+    if (id == INVALID_TIMER || index >= timers.size()) return false;
+
+    const Timer& timer = timers[index];
+    return timer.level != -1 && timer.generation == (id >> INDEX_BITS);
+}
+
+void TimerWheel::advance(float deltaTime, std::vector<Event>& due) {
+    accumulator += deltaTime;
+    uint64_t ticks = (uint64_t)(accumulator / tickLength);
+    accumulator -= ticks * tickLength;
+
+    for (uint64_t t = 0; t < ticks; t++) {
+        currentTick++;
+
+        // Cascade higher levels whenever the level below wraps around
+        for (int level = 1; level < LEVELS; level++) {
+            if ((currentTick >> (SLOT_BITS * (level - 1))) & SLOT_MASK) break;
+            cascade(level);
+        }
+
+        // Nothing to do for an empty slot
+        int slot = currentTick & SLOT_MASK;
+        int32_t index = slots[0][slot];
+        if (index == -1) continue;
+        slots[0][slot] = -1;
+
+        while (index != -1) {
+            Timer& timer = timers[index];
+            int32_t next = timer.next;
+            timer.level = timer.slot = -1;
+            timer.prev = timer.next = -1;
+
+            if (timer.expires > currentTick) {
+                // Clamped far-future timer, put it back where it belongs
+                insert(index);
+            } else {
+                due.push_back(timer.event);
+                if (timer.period) {
+                    timer.expires += timer.period;
+                    insert(index);
+                } else {
+                    release(index);
+                }
+            }
+            index = next;
+        }
+    }
+}
+
+void TimerWheel::insert(uint32_t index) {
+    Timer& timer = timers[index];
+    uint64_t delta = (timer.expires > currentTick) ? timer.expires - currentTick : 0;
+    uint64_t expires = currentTick + std::min(delta, MAX_DELTA);
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1ull << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    int slot = (expires >> (SLOT_BITS * level)) & SLOT_MASK;
+
+    // Push to the front of the slot list
+    timer.level = level;
+    timer.slot = slot;
+    timer.prev = -1;
+    timer.next = slots[level][slot];
+    if (timer.next != -1) timers[timer.next].prev = index;
+    slots[level][slot] = index;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Timer& timer = timers[index];
+    if (timer.prev != -1) {
+        timers[timer.prev].next = timer.next;
+    } else {
+        slots[timer.level][timer.slot] = timer.next;
+    }
+    if (timer.next != -1) timers[timer.next].prev = timer.prev;
+
+    timer.prev = timer.next = -1;
+    timer.level = timer.slot = -1;
+}
+
+void TimerWheel::cascade(int level) {
+    int slot = (currentTick >> (SLOT_BITS * level)) & SLOT_MASK;
+    int32_t index = slots[level][slot];
+    slots[level][slot] = -1;
+
+    while (index != -1) {
+        int32_t next = timers[index].next;
+        insert(index);
+        index = next;
+    }
+}
+
+void TimerWheel::release(uint32_t index) {
+    Timer& timer = timers[index];
+    timer.event = Event();
+    timer.level = timer.slot = -1;
+    // Generations wrap before 0xFFF so a handle can never equal INVALID_TIMER
+    timer.generation = (timer.generation + 1) % 0xFFF;
+    freeList.push_back(index);
+    activeTimers--;
+}
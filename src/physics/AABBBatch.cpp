@@ -0,0 +1,276 @@
+#include "physics/AABBBatch.h"
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SWIFT_X86 1
+#include <immintrin.h>
+#endif
+
+static constexpr float INF = std::numeric_limits<float>::infinity();
+
+// Directions closer to zero than this are treated as parallel to the slab, like rayDetectionAABB
+static constexpr float PARALLEL_EPSILON = 1e-5f;
+
+void AABBBatch::clear() {
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+    count = 0;
+}
+
+void AABBBatch::add(const AABB& box) {
+    if (count == minX.size()) {
+        // Grow by a whole group of empty boxes (min > max), their bits are cleared after each kernel
+        size_t padded = minX.size() + BATCH_WIDTH;
+        minX.resize(padded, INF); minY.resize(padded, INF); minZ.resize(padded, INF);
+        maxX.resize(padded, -INF); maxY.resize(padded, -INF); maxZ.resize(padded, -INF);
+    }
+
+    minX[count] = box.min.x; minY[count] = box.min.y; minZ[count] = box.min.z;
+    maxX[count] = box.max.x; maxY[count] = box.max.y; maxZ[count] = box.max.z;
+    count++;
+}
+
+AABB AABBBatch::get(size_t index) const {
+    return { Vec3(minX[index], minY[index], minZ[index]), Vec3(maxX[index], maxY[index], maxZ[index]) };
+}
+
+// Ray data shared by all boxes of a batch
+struct RaySetup {
+    float origin[3];
+    float inverse[3];
+    bool parallel[3];
+};
+
+static RaySetup setupRay(const Vec3& origin, const Vec3& direction) {
+    RaySetup ray;
+    const float o[3] = { origin.x, origin.y, origin.z };
+    const float d[3] = { direction.x, direction.y, direction.z };
+    for (int axis = 0; axis < 3; axis++) {
+        ray.origin[axis] = o[axis];
+        ray.parallel[axis] = std::fabs(d[axis]) <= PARALLEL_EPSILON;
+        ray.inverse[axis] = ray.parallel[axis] ? 0.0f : 1.0f / d[axis];
+    }
+    return ray;
+}
+
+// Scalar kernels, also the reference the SIMD versions are tested against
+
+static void overlapScalar(const AABBBatch& batch, const AABB& box, uint8_t* masks) {
+    for (size_t group = 0; group < batch.maskSize(); group++) {
+        uint8_t bits = 0;
+        for (size_t lane = 0; lane < 8; lane++) {
+            size_t i = group * 8 + lane;
+            bool hit = batch.minX[i] <= box.max.x && batch.maxX[i] >= box.min.x &&
+                       batch.minY[i] <= box.max.y && batch.maxY[i] >= box.min.y &&
+                       batch.minZ[i] <= box.max.z && batch.maxZ[i] >= box.min.z;
+            bits |= (uint8_t)hit << lane;
+        }
+        masks[group] = bits;
+    }
+}
+
+static void rayScalar(const AABBBatch& batch, const RaySetup& ray, float maxT, float* tEntry, uint8_t* masks) {
+    const float* mins[3] = { batch.minX.data(), batch.minY.data(), batch.minZ.data() };
+    const float* maxs[3] = { batch.maxX.data(), batch.maxY.data(), batch.maxZ.data() };
+
+    for (size_t group = 0; group < batch.maskSize(); group++) {
+        uint8_t bits = 0;
+        for (size_t lane = 0; lane < 8; lane++) {
+            size_t i = group * 8 + lane;
+            float tNear = -INF, tFar = INF;
+            bool inside = true;
+            for (int axis = 0; axis < 3; axis++) {
+                if (ray.parallel[axis]) {
+                    inside &= ray.origin[axis] >= mins[axis][i] && ray.origin[axis] <= maxs[axis][i];
+                    continue;
+                }
+                float t1 = (mins[axis][i] - ray.origin[axis]) * ray.inverse[axis];
+                float t2 = (maxs[axis][i] - ray.origin[axis]) * ray.inverse[axis];
+                tNear = std::max(tNear, std::min(t1, t2));
+                tFar = std::min(tFar, std::max(t1, t2));
+            }
+            tEntry[i] = tNear;
+            bool hit = inside && tNear <= tFar && tFar >= 0.0f && tNear <= maxT;
+            bits |= (uint8_t)hit << lane;
+        }
+        masks[group] = bits;
+    }
+}
+
+#ifdef SWIFT_X86
+
+// SSE kernels, two groups of 4 per mask byte
+
+__attribute__((target("sse2")))
+static void overlapSSE(const AABBBatch& batch, const AABB& box, uint8_t* masks) {
+    const __m128 boxMinX = _mm_set1_ps(box.min.x), boxMaxX = _mm_set1_ps(box.max.x);
+    const __m128 boxMinY = _mm_set1_ps(box.min.y), boxMaxY = _mm_set1_ps(box.max.y);
+    const __m128 boxMinZ = _mm_set1_ps(box.min.z), boxMaxZ = _mm_set1_ps(box.max.z);
+
+    for (size_t i = 0; i < batch.paddedSize(); i += 4) {
+        __m128 hit = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&batch.minX[i]), boxMaxX),
+                                _mm_cmpge_ps(_mm_loadu_ps(&batch.maxX[i]), boxMinX));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&batch.minY[i]), boxMaxY),
+                                         _mm_cmpge_ps(_mm_loadu_ps(&batch.maxY[i]), boxMinY)));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&batch.minZ[i]), boxMaxZ),
+                                         _mm_cmpge_ps(_mm_loadu_ps(&batch.maxZ[i]), boxMinZ)));
+
+        int bits = _mm_movemask_ps(hit);
+        if (i % 8 == 0) masks[i / 8] = (uint8_t)bits;
+        else masks[i / 8] |= (uint8_t)(bits << 4);
+    }
+}
+
+__attribute__((target("sse2")))
+static void raySSE(const AABBBatch& batch, const RaySetup& ray, float maxT, float* tEntry, uint8_t* masks) {
+    const float* mins[3] = { batch.minX.data(), batch.minY.data(), batch.minZ.data() };
+    const float* maxs[3] = { batch.maxX.data(), batch.maxY.data(), batch.maxZ.data() };
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 limit = _mm_set1_ps(maxT);
+
+    for (size_t i = 0; i < batch.paddedSize(); i += 4) {
+        __m128 tNear = _mm_set1_ps(-INF), tFar = _mm_set1_ps(INF);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int axis = 0; axis < 3; axis++) {
+            __m128 origin = _mm_set1_ps(ray.origin[axis]);
+            __m128 boxMin = _mm_loadu_ps(mins[axis] + i);
+            __m128 boxMax = _mm_loadu_ps(maxs[axis] + i);
+            if (ray.parallel[axis]) {
+                inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(origin, boxMin), _mm_cmple_ps(origin, boxMax)));
+                continue;
+            }
+            __m128 inverse = _mm_set1_ps(ray.inverse[axis]);
+            __m128 t1 = _mm_mul_ps(_mm_sub_ps(boxMin, origin), inverse);
+            __m128 t2 = _mm_mul_ps(_mm_sub_ps(boxMax, origin), inverse);
+            tNear = _mm_max_ps(tNear, _mm_min_ps(t1, t2));
+            tFar = _mm_min_ps(tFar, _mm_max_ps(t1, t2));
+        }
+        _mm_storeu_ps(tEntry + i, tNear);
+
+        __m128 hit = _mm_and_ps(inside, _mm_cmple_ps(tNear, tFar));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmpge_ps(tFar, zero), _mm_cmple_ps(tNear, limit)));
+
+        int bits = _mm_movemask_ps(hit);
+        if (i % 8 == 0) masks[i / 8] = (uint8_t)bits;
+        else masks[i / 8] |= (uint8_t)(bits << 4);
+    }
+}
+
+// AVX2 kernels, one group of 8 per mask byte
+
+__attribute__((target("avx2")))
+static void overlapAVX2(const AABBBatch& batch, const AABB& box, uint8_t* masks) {
+    const __m256 boxMinX = _mm256_set1_ps(box.min.x), boxMaxX = _mm256_set1_ps(box.max.x);
+    const __m256 boxMinY = _mm256_set1_ps(box.min.y), boxMaxY = _mm256_set1_ps(box.max.y);
+    const __m256 boxMinZ = _mm256_set1_ps(box.min.z), boxMaxZ = _mm256_set1_ps(box.max.z);
+
+    for (size_t i = 0; i < batch.paddedSize(); i += 8) {
+        __m256 hit = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(&batch.minX[i]), boxMaxX, _CMP_LE_OQ),
+                                   _mm256_cmp_ps(_mm256_loadu_ps(&batch.maxX[i]), boxMinX, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(&batch.minY[i]), boxMaxY, _CMP_LE_OQ),
+                                               _mm256_cmp_ps(_mm256_loadu_ps(&batch.maxY[i]), boxMinY, _CMP_GE_OQ)));
+        hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(&batch.minZ[i]), boxMaxZ, _CMP_LE_OQ),
+                                               _mm256_cmp_ps(_mm256_loadu_ps(&batch.maxZ[i]), boxMinZ, _CMP_GE_OQ)));
+        masks[i / 8] = (uint8_t)_mm256_movemask_ps(hit);
+    }
+}
+
+__attribute__((target("avx2")))
+static void rayAVX2(const AABBBatch& batch, const RaySetup& ray, float maxT, float* tEntry, uint8_t* masks) {
+    const float* mins[3] = { batch.minX.data(), batch.minY.data(), batch.minZ.data() };
+    const float* maxs[3] = { batch.maxX.data(), batch.maxY.data(), batch.maxZ.data() };
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 limit = _mm256_set1_ps(maxT);
+
+    for (size_t i = 0; i < batch.paddedSize(); i += 8) {
+        __m256 tNear = _mm256_set1_ps(-INF), tFar = _mm256_set1_ps(INF);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int axis = 0; axis < 3; axis++) {
+            __m256 origin = _mm256_set1_ps(ray.origin[axis]);
+            __m256 boxMin = _mm256_loadu_ps(mins[axis] + i);
+            __m256 boxMax = _mm256_loadu_ps(maxs[axis] + i);
+            if (ray.parallel[axis]) {
+                inside = _mm256_and_ps(inside, _mm256_and_ps(_mm256_cmp_ps(origin, boxMin, _CMP_GE_OQ),
+                                                             _mm256_cmp_ps(origin, boxMax, _CMP_LE_OQ)));
+                continue;
+            }
+            __m256 inverse = _mm256_set1_ps(ray.inverse[axis]);
+            __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(boxMin, origin), inverse);
+            __m256 t2 = _mm256_mul_ps(_mm256_sub_ps(boxMax, origin), inverse);
+            tNear = _mm256_max_ps(tNear, _mm256_min_ps(t1, t2));
+            tFar = _mm256_min_ps(tFar, _mm256_max_ps(t1, t2));
+        }
+        _mm256_storeu_ps(tEntry + i, tNear);
+
+        __m256 hit = _mm256_and_ps(inside, _mm256_cmp_ps(tNear, tFar, _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(tFar, zero, _CMP_GE_OQ),
+                                               _mm256_cmp_ps(tNear, limit, _CMP_LE_OQ)));
+        masks[i / 8] = (uint8_t)_mm256_movemask_ps(hit);
+    }
+}
+
+#endif
+
+SimdLevel getSupportedSimdLevel() {
+    static SimdLevel supported = [] {
+#ifdef SWIFT_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+        if (__builtin_cpu_supports("sse2")) return SIMD_SSE;
+#endif
+        return SIMD_SCALAR;
+    }();
+    return supported;
+}
+
+static SimdLevel activeLevel = getSupportedSimdLevel();
+
+SimdLevel getSimdLevel() {
+    return activeLevel;
+}
+
+void setSimdLevel(SimdLevel level) {
+    activeLevel = std::min(level, getSupportedSimdLevel());
+}
+
+const char* getSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SIMD_AVX2: return "avx2";
+        case SIMD_SSE: return "sse";
+        default: return "scalar";
+    }
+}
+
+// Padding lanes can pass the slab test (their inverted slabs span every t), never report them
+static void clearPadding(const AABBBatch& batch, uint8_t* masks) {
+    size_t used = batch.size() % 8;
+    if (used) masks[batch.size() / 8] &= (uint8_t)((1u << used) - 1);
+}
+
+void overlapBatch(const AABBBatch& batch, const AABB& box, uint8_t* masks) {
+#ifdef SWIFT_X86
+    if (activeLevel == SIMD_AVX2) overlapAVX2(batch, box, masks);
+    else if (activeLevel == SIMD_SSE) overlapSSE(batch, box, masks);
+    else
+#endif
+    overlapScalar(batch, box, masks);
+    clearPadding(batch, masks);
+}
+
+void containsPointBatch(const AABBBatch& batch, const Vec3& point, uint8_t* masks) {
+    // A point is a degenerate box
+    overlapBatch(batch, AABB(point, point), masks);
+}
+
+void rayBatch(const AABBBatch& batch, const Vec3& origin, const Vec3& direction, float maxT,
+              float* tEntry, uint8_t* masks) {
+    RaySetup ray = setupRay(origin, direction);
+#ifdef SWIFT_X86
+    if (activeLevel == SIMD_AVX2) rayAVX2(batch, ray, maxT, tEntry, masks);
+    else if (activeLevel == SIMD_SSE) raySSE(batch, ray, maxT, tEntry, masks);
+    else
+#endif
+    rayScalar(batch, ray, maxT, tEntry, masks);
+    clearPadding(batch, masks);
+}
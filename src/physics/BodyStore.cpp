@@ -0,0 +1,119 @@
+#include "physics/BodyStore.h"
+#include "physics/AABBBatch.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SWIFT_X86 1
+#include <immintrin.h>
+#endif
+
+void BodyStore::resize(size_t bodies) {
+    size_t padded = (bodies + BATCH_WIDTH - 1) / BATCH_WIDTH * BATCH_WIDTH;
+    count = bodies;
+
+    // Padding is only ever integrated, keep it zero so it stays finite
+    for (std::vector<float>* array : { &px, &py, &pz, &vx, &vy, &vz, &ax, &ay, &az, &inverseMass, &deltaTime }) {
+        array->resize(padded);
+        std::fill(array->begin() + bodies, array->end(), 0.0f);
+    }
+    entities.resize(padded);
+    flags.resize(padded);
+    contacts.resize(padded);
+}
+
+enum IntegrateParts {
+    INTEGRATE_VELOCITY = 1 << 0,
+    INTEGRATE_POSITION = 1 << 1,
+};
+
+// Same operations in the same order as the SIMD versions (multiply then add, never fused)
+static void integrateScalar(BodyStore& store, size_t begin, size_t end, int parts) {
+    float* positions[3] = { store.px.data(), store.py.data(), store.pz.data() };
+    float* velocities[3] = { store.vx.data(), store.vy.data(), store.vz.data() };
+    const float* accelerations[3] = { store.ax.data(), store.ay.data(), store.az.data() };
+    const float* dt = store.deltaTime.data();
+
+    for (int axis = 0; axis < 3; axis++) {
+        float* p = positions[axis];
+        float* v = velocities[axis];
+        const float* a = accelerations[axis];
+        for (size_t i = begin; i < end; i++) {
+            if (parts & INTEGRATE_VELOCITY) v[i] = v[i] + a[i] * dt[i];
+            if (parts & INTEGRATE_POSITION) p[i] = p[i] + v[i] * dt[i];
+        }
+    }
+}
+
+#ifdef SWIFT_X86
+
+__attribute__((target("sse2")))
+static void integrateSSE(BodyStore& store, size_t begin, size_t end, int parts) {
+    float* positions[3] = { store.px.data(), store.py.data(), store.pz.data() };
+    float* velocities[3] = { store.vx.data(), store.vy.data(), store.vz.data() };
+    const float* accelerations[3] = { store.ax.data(), store.ay.data(), store.az.data() };
+
+    for (int axis = 0; axis < 3; axis++) {
+        for (size_t i = begin; i < end; i += 4) {
+            __m128 dt = _mm_loadu_ps(store.deltaTime.data() + i);
+            __m128 v = _mm_loadu_ps(velocities[axis] + i);
+            if (parts & INTEGRATE_VELOCITY) {
+                v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(accelerations[axis] + i), dt));
+                _mm_storeu_ps(velocities[axis] + i, v);
+            }
+            if (parts & INTEGRATE_POSITION) {
+                _mm_storeu_ps(positions[axis] + i, _mm_add_ps(_mm_loadu_ps(positions[axis] + i), _mm_mul_ps(v, dt)));
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void integrateAVX2(BodyStore& store, size_t begin, size_t end, int parts) {
+    float* positions[3] = { store.px.data(), store.py.data(), store.pz.data() };
+    float* velocities[3] = { store.vx.data(), store.vy.data(), store.vz.data() };
+    const float* accelerations[3] = { store.ax.data(), store.ay.data(), store.az.data() };
+
+    for (int axis = 0; axis < 3; axis++) {
+        for (size_t i = begin; i < end; i += 8) {
+            __m256 dt = _mm256_loadu_ps(store.deltaTime.data() + i);
+            __m256 v = _mm256_loadu_ps(velocities[axis] + i);
+            if (parts & INTEGRATE_VELOCITY) {
+                v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_loadu_ps(accelerations[axis] + i), dt));
+                _mm256_storeu_ps(velocities[axis] + i, v);
+            }
+            if (parts & INTEGRATE_POSITION) {
+                _mm256_storeu_ps(positions[axis] + i,
+                                 _mm256_add_ps(_mm256_loadu_ps(positions[axis] + i), _mm256_mul_ps(v, dt)));
+            }
+        }
+    }
+}
+
+#endif
+
+static void integrate(BodyStore& store, size_t begin, size_t end, int parts) {
+    // Finish the last group, padding lanes are zero and stay zero
+    end = std::min((end + BodyStore::BATCH_WIDTH - 1) / BodyStore::BATCH_WIDTH * BodyStore::BATCH_WIDTH,
+                   store.paddedSize());
+    if (begin >= end) return;
+
+#ifdef SWIFT_X86
+    SimdLevel level = getSimdLevel();
+    if (level == SIMD_AVX2) integrateAVX2(store, begin, end, parts);
+    else if (level == SIMD_SSE) integrateSSE(store, begin, end, parts);
+    else
+#endif
+    integrateScalar(store, begin, end, parts);
+}
+
+void integrateBodies(BodyStore& store, size_t begin, size_t end) {
+    integrate(store, begin, end, INTEGRATE_VELOCITY | INTEGRATE_POSITION);
+}
+
+void integrateVelocities(BodyStore& store, size_t begin, size_t end) {
+    integrate(store, begin, end, INTEGRATE_VELOCITY);
+}
+
+void integratePositions(BodyStore& store, size_t begin, size_t end) {
+    integrate(store, begin, end, INTEGRATE_POSITION);
+}
@@ -0,0 +1,11 @@
+#include "physics/Broadphase.h"
+#include "physics/SpatialHash.h"
+#include "physics/DynamicAABBTree.h"
+
+std::unique_ptr<IBroadphase> createBroadphase(BroadphaseType type) {
+    switch (type) {
+        case BROADPHASE_AABB_TREE: return std::make_unique<DynamicAABBTree>(0.1f);
+        case BROADPHASE_SPATIAL_HASH:
+        default: return std::make_unique<SpatialHash>(2.0f);
+    }
+}
@@ -0,0 +1,91 @@
+#include "physics/ContactSolver.h"
+#include <algorithm>
+#include <cmath>
+
+static Vec3 velocityOf(const BodyStore& store, int32_t body) {
+    return body >= 0 ? store.getVelocity(body) : Vec3(0, 0, 0);
+}
+
+static float inverseMassOf(const BodyStore& store, int32_t body) {
+    return body >= 0 ? store.inverseMass[body] : 0.0f;
+}
+
+// Push body A by 'impulse' and body B by the opposite
+static void applyImpulse(BodyStore& store, const Contact& contact, const Vec3& impulse) {
+    store.setVelocity(contact.bodyA, store.getVelocity(contact.bodyA) + impulse * store.inverseMass[contact.bodyA]);
+    if (contact.bodyB >= 0) {
+        store.setVelocity(contact.bodyB, store.getVelocity(contact.bodyB) - impulse * store.inverseMass[contact.bodyB]);
+    }
+}
+
+void prepareContacts(BodyStore& store, Contact* contacts, size_t count, const ContactSettings& settings) {
+    for (size_t i = 0; i < count; i++) {
+        Contact& contact = contacts[i];
+        float deltaTime = store.deltaTime[contact.bodyA];
+
+        // The two axes across the normal, from whichever of x and y is further from it
+        Vec3 axis = std::fabs(contact.normal.x) > 0.7f ? Vec3(0, 1, 0) : Vec3(1, 0, 0);
+        contact.tangent[0] = normalise(axis - contact.normal * dot(axis, contact.normal));
+        contact.tangent[1] = cross(contact.normal, contact.tangent[0]);
+
+        float inverseMass = store.inverseMass[contact.bodyA] + inverseMassOf(store, contact.bodyB);
+        contact.mass = inverseMass > 0.0f ? 1.0f / inverseMass : 0.0f;
+
+        // Touching contacts bounce off fast impacts. Contacts further away let the body close the gap
+        // within this step but no further, and penetrating ones are pushed apart over a few steps.
+        float normalVelocity = dot(store.getVelocity(contact.bodyA) - velocityOf(store, contact.bodyB), contact.normal);
+        float gap = contact.separation - settings.restOffset;
+        bool touching = contact.separation <= settings.restOffset * 2.0f;
+        if (touching && normalVelocity < -settings.restitutionThreshold) {
+            contact.targetVelocity = -settings.restitution * normalVelocity;
+        } else if (gap > 0.0f) {
+            contact.targetVelocity = -gap / deltaTime;
+        } else {
+            contact.targetVelocity = std::min(-settings.baumgarte * gap / deltaTime, settings.maxPushVelocity);
+        }
+    }
+
+    // Start from last step's impulses, resting contacts barely change so the solver has little left to do
+    for (size_t i = 0; i < count; i++) {
+        const Contact& contact = contacts[i];
+        Vec3 impulse = contact.normal * contact.normalImpulse + contact.tangent[0] * contact.tangentImpulse[0] +
+                       contact.tangent[1] * contact.tangentImpulse[1];
+        applyImpulse(store, contact, impulse);
+    }
+}
+
+int solveContacts(BodyStore& store, Contact* contacts, size_t count, const ContactSettings& settings) {
+    int iteration = 0;
+    while (iteration < settings.iterations) {
+        iteration++;
+        float largestChange = 0.0f;
+
+        for (size_t i = 0; i < count; i++) {
+            Contact& contact = contacts[i];
+
+            // Friction first, bounded by the normal impulse of the previous iteration
+            float maxFriction = settings.friction * contact.normalImpulse;
+            for (int axis = 0; axis < 2; axis++) {
+                Vec3 relative = store.getVelocity(contact.bodyA) - velocityOf(store, contact.bodyB);
+                float lambda = -contact.mass * dot(relative, contact.tangent[axis]);
+                float accumulated = std::clamp(contact.tangentImpulse[axis] + lambda, -maxFriction, maxFriction);
+                lambda = accumulated - contact.tangentImpulse[axis];
+                contact.tangentImpulse[axis] = accumulated;
+                applyImpulse(store, contact, contact.tangent[axis] * lambda);
+                largestChange = std::max(largestChange, std::fabs(lambda));
+            }
+
+            // Contacts only push, the accumulated normal impulse never goes below zero
+            Vec3 relative = store.getVelocity(contact.bodyA) - velocityOf(store, contact.bodyB);
+            float lambda = contact.mass * (contact.targetVelocity - dot(relative, contact.normal));
+            float accumulated = std::max(contact.normalImpulse + lambda, 0.0f);
+            lambda = accumulated - contact.normalImpulse;
+            contact.normalImpulse = accumulated;
+            applyImpulse(store, contact, contact.normal * lambda);
+            largestChange = std::max(largestChange, std::fabs(lambda));
+        }
+
+        if (largestChange < settings.tolerance) break;
+    }
+    return iteration;
+}
@@ -0,0 +1,286 @@
+#include "physics/DynamicAABBTree.h"
+#include <cmath>
+#include <utility>
+
+int32_t DynamicAABBTree::allocateNode() {
+    int32_t node;
+    if (freeList != NULL_NODE) {
+        node = freeList;
+        freeList = nodes[node].parent;
+    } else {
+        node = nodes.size();
+        nodes.emplace_back();
+    }
+
+    nodes[node] = Node();
+    nodes[node].height = 0;
+    return node;
+}
+
+void DynamicAABBTree::freeNode(int32_t node) {
+    nodes[node].parent = freeList;
+    nodes[node].left = nodes[node].right = NULL_NODE;
+    nodes[node].height = -1;
+    freeList = node;
+}
+
+void DynamicAABBTree::update(Entity entity, const AABB& bounds) {
+    auto it = leaves.find(entity);
+    if (it == leaves.end()) {
+        int32_t leaf = allocateNode();
+        nodes[leaf].entity = entity;
+        nodes[leaf].bounds = expand(bounds, margin);
+        insertLeaf(leaf);
+        leaves[entity] = leaf;
+        return;
+    }
+
+    // Moving inside the fat box is free, unless the box has become far bigger than needed
+    int32_t leaf = it->second;
+    const AABB& fat = nodes[leaf].bounds;
+    if (::contains(fat, bounds) && ::contains(expand(bounds, margin * 4.0f), fat)) return;
+
+    removeLeaf(leaf);
+    nodes[leaf].bounds = expand(bounds, margin);
+    insertLeaf(leaf);
+}
+
+void DynamicAABBTree::remove(Entity entity) {
+    auto it = leaves.find(entity);
+    if (it == leaves.end()) return;
+
+    removeLeaf(it->second);
+    freeNode(it->second);
+    leaves.erase(it);
+}
+
+void DynamicAABBTree::setLayers(Entity entity, uint32_t layers) {
+    auto it = leaves.find(entity);
+    if (it == leaves.end()) return;
+
+    // Only the unions on the way up change, the shape of the tree stays the same
+    int32_t node = it->second;
+    nodes[node].layers = layers;
+    for (node = nodes[node].parent; node != NULL_NODE; node = nodes[node].parent) {
+        nodes[node].layers = nodes[nodes[node].left].layers | nodes[nodes[node].right].layers;
+    }
+}
+
+void DynamicAABBTree::insertLeaf(int32_t leaf) {
+    if (root == NULL_NODE) {
+        root = leaf;
+        nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // Walk down towards the sibling that grows the total surface area the least
+    AABB leafBounds = nodes[leaf].bounds;
+    int32_t index = root;
+    while (!nodes[index].isLeaf()) {
+        const Node& node = nodes[index];
+        float area = surfaceArea(node.bounds);
+        float combinedArea = surfaceArea(merge(node.bounds, leafBounds));
+
+        // Cost of pairing with this node, and the cost pushed down onto its children
+        float cost = 2.0f * combinedArea;
+        float inheritance = 2.0f * (combinedArea - area);
+
+        float childCost[2];
+        int32_t children[2] = { node.left, node.right };
+        for (int i = 0; i < 2; i++) {
+            const Node& child = nodes[children[i]];
+            float grown = surfaceArea(merge(child.bounds, leafBounds));
+            childCost[i] = (child.isLeaf() ? grown : grown - surfaceArea(child.bounds)) + inheritance;
+        }
+
+        if (cost < childCost[0] && cost < childCost[1]) break;
+        index = childCost[0] < childCost[1] ? children[0] : children[1];
+    }
+
+    // Replace the sibling with a new parent holding both
+    int32_t sibling = index;
+    int32_t oldParent = nodes[sibling].parent;
+    int32_t newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].bounds = merge(leafBounds, nodes[sibling].bounds);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].layers = nodes[leaf].layers | nodes[sibling].layers;
+    nodes[newParent].left = sibling;
+    nodes[newParent].right = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent == NULL_NODE) {
+        root = newParent;
+    } else if (nodes[oldParent].left == sibling) {
+        nodes[oldParent].left = newParent;
+    } else {
+        nodes[oldParent].right = newParent;
+    }
+
+    refit(oldParent);
+}
+
+void DynamicAABBTree::removeLeaf(int32_t leaf) {
+    if (leaf == root) {
+        root = NULL_NODE;
+        return;
+    }
+
+    // The sibling takes the place of the parent
+    int32_t parent = nodes[leaf].parent;
+    int32_t grandParent = nodes[parent].parent;
+    int32_t sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+    nodes[sibling].parent = grandParent;
+    nodes[leaf].parent = NULL_NODE;
+    if (grandParent == NULL_NODE) {
+        root = sibling;
+    } else if (nodes[grandParent].left == parent) {
+        nodes[grandParent].left = sibling;
+    } else {
+        nodes[grandParent].right = sibling;
+    }
+    freeNode(parent);
+
+    refit(grandParent);
+}
+
+void DynamicAABBTree::refit(int32_t node) {
+    while (node != NULL_NODE) {
+        node = balance(node);
+
+        Node& current = nodes[node];
+        const Node& left = nodes[current.left];
+        const Node& right = nodes[current.right];
+        current.height = 1 + std::max(left.height, right.height);
+        current.bounds = merge(left.bounds, right.bounds);
+        current.layers = left.layers | right.layers;
+
+        node = current.parent;
+    }
+}
+
+int32_t DynamicAABBTree::balance(int32_t a) {
+    if (nodes[a].isLeaf() || nodes[a].height < 2) return a;
+
+    int32_t b = nodes[a].left;
+    int32_t c = nodes[a].right;
+    int32_t difference = nodes[c].height - nodes[b].height;
+    if (difference >= -1 && difference <= 1) return a;
+
+    // Promote the taller child x into a's place
+    int32_t x = difference > 0 ? c : b;
+    int32_t f = nodes[x].left;
+    int32_t g = nodes[x].right;
+    if (nodes[f].height < nodes[g].height) std::swap(f, g);
+
+    int32_t parent = nodes[a].parent;
+    nodes[x].parent = parent;
+    if (parent == NULL_NODE) {
+        root = x;
+    } else if (nodes[parent].left == a) {
+        nodes[parent].left = x;
+    } else {
+        nodes[parent].right = x;
+    }
+
+    // a keeps its other child and takes the shorter grandchild g, x keeps the taller one f
+    if (nodes[a].left == x) {
+        nodes[a].left = g;
+    } else {
+        nodes[a].right = g;
+    }
+    nodes[g].parent = a;
+    nodes[x].left = a;
+    nodes[x].right = f;
+    nodes[a].parent = x;
+
+    Node& nodeA = nodes[a];
+    nodeA.bounds = merge(nodes[nodeA.left].bounds, nodes[nodeA.right].bounds);
+    nodeA.height = 1 + std::max(nodes[nodeA.left].height, nodes[nodeA.right].height);
+    nodeA.layers = nodes[nodeA.left].layers | nodes[nodeA.right].layers;
+
+    Node& nodeX = nodes[x];
+    nodeX.bounds = merge(nodeA.bounds, nodes[f].bounds);
+    nodeX.height = 1 + std::max(nodeA.height, nodes[f].height);
+    nodeX.layers = nodeA.layers | nodes[f].layers;
+
+    return x;
+}
+
+void DynamicAABBTree::query(const AABB& bounds, std::vector<Entity>& result, uint32_t layerMask) const {
+    if (root == NULL_NODE) return;
+
+    // One traversal stack per thread so queries can run in parallel
+    static thread_local std::vector<int32_t> stack;
+    stack.clear();
+    stack.push_back(root);
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+
+        if (!(node.layers & layerMask) || !overlaps(node.bounds, bounds)) continue;
+        if (node.isLeaf()) {
+            result.push_back(node.entity);
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void DynamicAABBTree::raycast(const Vec3& origin, const Vec3& direction, float maxT, std::vector<Entity>& result,
+                              uint32_t layerMask) const {
+    if (root == NULL_NODE) return;
+
+    // Division by zero gives infinities which the slab test handles
+    Vec3 inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+    static thread_local std::vector<int32_t> stack;
+    stack.clear();
+    stack.push_back(root);
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+
+        if (!(node.layers & layerMask) || !rayOverlaps(node.bounds, origin, inverseDirection, maxT)) continue;
+        if (node.isLeaf()) {
+            result.push_back(node.entity);
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+void DynamicAABBTree::clear() {
+    nodes.clear();
+    leaves.clear();
+    freeList = NULL_NODE;
+    root = NULL_NODE;
+}
+
+bool DynamicAABBTree::validate() const {
+    if (root == NULL_NODE) return leaves.empty();
+    if (nodes[root].parent != NULL_NODE) return false;
+
+    for (const auto& [entity, leaf] : leaves) {
+        if (!nodes[leaf].isLeaf() || nodes[leaf].entity != entity) return false;
+    }
+    return validate(root);
+}
+
+bool DynamicAABBTree::validate(int32_t node) const {
+    const Node& current = nodes[node];
+    if (current.isLeaf()) return current.height == 0 && current.right == NULL_NODE;
+
+    const Node& left = nodes[current.left];
+    const Node& right = nodes[current.right];
+    if (left.parent != node || right.parent != node) return false;
+    if (current.height != 1 + std::max(left.height, right.height)) return false;
+    if (!::contains(current.bounds, left.bounds) || !::contains(current.bounds, right.bounds)) return false;
+    if (current.layers != (left.layers | right.layers)) return false;
+
+    return validate(current.left) && validate(current.right);
+}
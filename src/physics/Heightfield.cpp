@@ -0,0 +1,449 @@
+#include "physics/Heightfield.h"
+#include "physics/Triangle.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <string>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+// Narrow [tMin, tMax] to where start + direction * t lies in [lo, hi]
+static bool clipSlab(float start, float direction, float lo, float hi, float& tMin, float& tMax) {
+    if (direction == 0.0f) return start >= lo && start <= hi;
+    float t1 = (lo - start) / direction;
+    float t2 = (hi - start) / direction;
+    if (t1 > t2) std::swap(t1, t2);
+    tMin = std::max(tMin, t1);
+    tMax = std::min(tMax, t2);
+    return tMin <= tMax;
+}
+
+Heightfield::Heightfield(int width, int depth, float cellSize, const Vec3& origin, std::vector<float> heights)
+    : origin(origin), cellSize(cellSize > 0.0f ? cellSize : 1.0f), width(width), depth(depth), heights(std::move(heights)) {
+    if (this->heights.size() != (size_t)width * depth || width < 2 || depth < 2) {
+        std::cerr << "Heightfield needs at least 2 x 2 samples and one height per sample\n";
+        this->width = this->depth = 0;
+        this->heights.clear();
+        return;
+    }
+    for (float& height : this->heights) height += origin.y;
+    buildLevels();
+}
+
+// One vertex per sample of a regular grid with the same spacing along x and z, false otherwise
+static bool readGrid(const std::vector<Vec3>& positions, int& width, int& depth, float& spacing, Vec3& origin,
+                     std::vector<float>& heights) {
+    auto axisValues = [&](float Vec3::*axis, std::vector<float>& values) {
+        values.clear();
+        for (const Vec3& position : positions) values.push_back(position.*axis);
+        std::sort(values.begin(), values.end());
+        float tolerance = 1e-4f * std::max(1.0f, values.back() - values.front());
+        values.erase(std::unique(values.begin(), values.end(), [&](float a, float b) { return b - a <= tolerance; }),
+                     values.end());
+    };
+    auto evenlySpaced = [](const std::vector<float>& values, float& step) {
+        if (values.size() < 2) return false;
+        step = (values.back() - values.front()) / (values.size() - 1);
+        for (size_t i = 1; i < values.size(); i++) {
+            if (std::fabs(values[i] - values[i - 1] - step) > 1e-3f * step) return false;
+        }
+        return true;
+    };
+
+    std::vector<float> xs, zs;
+    axisValues(&Vec3::x, xs);
+    axisValues(&Vec3::z, zs);
+    float stepX, stepZ;
+    if (xs.size() * zs.size() != positions.size() || !evenlySpaced(xs, stepX) || !evenlySpaced(zs, stepZ) ||
+        std::fabs(stepX - stepZ) > 1e-3f * stepX) {
+        return false;
+    }
+
+    width = (int)xs.size();
+    depth = (int)zs.size();
+    spacing = stepX;
+    origin = Vec3(xs.front(), 0.0f, zs.front());
+    heights.assign(positions.size(), 0.0f);
+    std::vector<uint8_t> filled(positions.size(), 0);
+    for (const Vec3& position : positions) {
+        int x = (int)std::lround((position.x - origin.x) / spacing);
+        int z = (int)std::lround((position.z - origin.z) / spacing);
+        size_t i = (size_t)z * width + x;
+        if (filled[i]) return false; // two vertices on one sample, it's not a height map
+        filled[i] = 1;
+        heights[i] = position.y;
+    }
+    return true;
+}
+
+Heightfield::Heightfield(const std::vector<Vec3>& positions, const std::vector<uint32_t>& triangles, float cellSize) {
+    if (positions.empty()) return;
+    if (readGrid(positions, width, depth, this->cellSize, origin, heights) && width >= 2 && depth >= 2) {
+        buildLevels();
+        return;
+    }
+
+    this->cellSize = cellSize > 0.0f ? cellSize : 1.0f;
+    Vec3 lowest = positions[0], highest = positions[0];
+    for (const Vec3& position : positions) {
+        lowest = minVec(lowest, position);
+        highest = maxVec(highest, position);
+    }
+    origin = Vec3(lowest.x, 0.0f, lowest.z);
+    width = std::max(2, (int)std::ceil((highest.x - lowest.x) / this->cellSize) + 1);
+    depth = std::max(2, (int)std::ceil((highest.z - lowest.z) / this->cellSize) + 1);
+
+    // Every sample takes the highest triangle above it
+    const float unset = -std::numeric_limits<float>::infinity();
+    heights.assign((size_t)width * depth, unset);
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        if (triangles[i] >= positions.size() || triangles[i + 1] >= positions.size() ||
+            triangles[i + 2] >= positions.size()) {
+            continue;
+        }
+        const Vec3& a = positions[triangles[i]];
+        const Vec3& b = positions[triangles[i + 1]];
+        const Vec3& c = positions[triangles[i + 2]];
+        float area = (b.x - a.x) * (c.z - a.z) - (c.x - a.x) * (b.z - a.z);
+        if (std::fabs(area) < 1e-12f) continue; // vertical, seen edge on from above
+
+        int minX = std::max(0, (int)std::ceil((std::min({ a.x, b.x, c.x }) - origin.x) / this->cellSize));
+        int maxX = std::min(width - 1, (int)std::floor((std::max({ a.x, b.x, c.x }) - origin.x) / this->cellSize));
+        int minZ = std::max(0, (int)std::ceil((std::min({ a.z, b.z, c.z }) - origin.z) / this->cellSize));
+        int maxZ = std::min(depth - 1, (int)std::floor((std::max({ a.z, b.z, c.z }) - origin.z) / this->cellSize));
+        for (int z = minZ; z <= maxZ; z++) {
+            for (int x = minX; x <= maxX; x++) {
+                float px = origin.x + x * this->cellSize, pz = origin.z + z * this->cellSize;
+                float wa = ((b.x - px) * (c.z - pz) - (c.x - px) * (b.z - pz)) / area;
+                float wb = ((c.x - px) * (a.z - pz) - (a.x - px) * (c.z - pz)) / area;
+                float wc = 1.0f - wa - wb;
+                const float slack = -1e-5f; // samples on a shared edge belong to both triangles
+                if (wa < slack || wb < slack || wc < slack) continue;
+
+                float& height = heights[(size_t)z * width + x];
+                height = std::max(height, wa * a.y + wb * b.y + wc * c.y);
+            }
+        }
+    }
+    for (float& height : heights) {
+        if (height == unset) height = lowest.y;
+    }
+    buildLevels();
+}
+
+Heightfield::Heightfield(const char* objFile, float cellSize) {
+    std::ifstream f(objFile);
+    if (!f.is_open()) {
+        std::cerr << "Error opening object file: " << objFile << "\n";
+        return;
+    }
+
+    // Only positions and faces matter, polygons are split into fans
+    std::vector<Vec3> positions;
+    std::vector<uint32_t> triangles;
+    std::string line;
+    while (std::getline(f, line)) {
+        std::stringstream s(line);
+        std::string type;
+        s >> type;
+        if (type == "v") {
+            Vec3 v;
+            s >> v.x >> v.y >> v.z;
+            positions.push_back(v);
+        } else if (type == "f") {
+            std::vector<uint32_t> face;
+            std::string token;
+            while (s >> token) {
+                int index = std::atoi(token.c_str()); // up to the first '/'
+                if (index < 0) index += (int)positions.size() + 1;
+                if (index <= 0) break;
+                face.push_back((uint32_t)index - 1);
+            }
+            for (size_t i = 2; i < face.size(); i++) {
+                triangles.insert(triangles.end(), { face[0], face[i - 1], face[i] });
+            }
+        }
+    }
+
+    *this = Heightfield(positions, triangles, cellSize);
+}
+
+void Heightfield::buildLevels() {
+    levels.clear();
+    Level cells;
+    cells.width = width - 1;
+    cells.depth = depth - 1;
+    cells.minHeights.resize((size_t)cells.width * cells.depth);
+    cells.maxHeights.resize((size_t)cells.width * cells.depth);
+    for (int z = 0; z < cells.depth; z++) {
+        for (int x = 0; x < cells.width; x++) {
+            float corners[4] = { getSample(x, z), getSample(x + 1, z), getSample(x, z + 1), getSample(x + 1, z + 1) };
+            cells.minHeights[(size_t)z * cells.width + x] = *std::min_element(corners, corners + 4);
+            cells.maxHeights[(size_t)z * cells.width + x] = *std::max_element(corners, corners + 4);
+        }
+    }
+    levels.push_back(std::move(cells));
+
+    while (levels.back().width > 1 || levels.back().depth > 1) {
+        const Level& below = levels.back();
+        Level level;
+        level.width = (below.width + 1) / 2;
+        level.depth = (below.depth + 1) / 2;
+        level.minHeights.assign((size_t)level.width * level.depth, std::numeric_limits<float>::infinity());
+        level.maxHeights.assign((size_t)level.width * level.depth, -std::numeric_limits<float>::infinity());
+        for (int z = 0; z < below.depth; z++) {
+            for (int x = 0; x < below.width; x++) {
+                size_t parent = (size_t)(z / 2) * level.width + x / 2;
+                size_t child = (size_t)z * below.width + x;
+                level.minHeights[parent] = std::min(level.minHeights[parent], below.minHeights[child]);
+                level.maxHeights[parent] = std::max(level.maxHeights[parent], below.maxHeights[child]);
+            }
+        }
+        levels.push_back(std::move(level));
+    }
+}
+
+AABB Heightfield::getBounds() const {
+    if (empty()) return AABB();
+    const Level& top = levels.back();
+    return { Vec3(origin.x, top.minHeights[0], origin.z),
+             Vec3(origin.x + (width - 1) * cellSize, top.maxHeights[0], origin.z + (depth - 1) * cellSize) };
+}
+
+float Heightfield::cellHeight(int x, int z, float u, float v, Vec3* normal) const {
+    u = std::clamp(u, 0.0f, 1.0f);
+    v = std::clamp(v, 0.0f, 1.0f);
+    float h00 = getSample(x, z), h10 = getSample(x + 1, z);
+    float h01 = getSample(x, z + 1), h11 = getSample(x + 1, z + 1);
+
+    // Slopes of the triangle on this side of the diagonal
+    float slopeX, slopeZ;
+    if (u >= v) {
+        slopeX = h10 - h00;
+        slopeZ = h11 - h10;
+    } else {
+        slopeX = h11 - h01;
+        slopeZ = h01 - h00;
+    }
+    if (normal) *normal = normalise(Vec3(-slopeX / cellSize, 1.0f, -slopeZ / cellSize));
+    return h00 + slopeX * u + slopeZ * v;
+}
+
+bool Heightfield::getHeight(float x, float z, float& height, Vec3* normal) const {
+    if (empty()) return false;
+    float fx = (x - origin.x) / cellSize;
+    float fz = (z - origin.z) / cellSize;
+    if (!(fx >= 0.0f && fx <= width - 1 && fz >= 0.0f && fz <= depth - 1)) return false;
+
+    int cellX = std::min((int)fx, width - 2);
+    int cellZ = std::min((int)fz, depth - 2);
+    height = cellHeight(cellX, cellZ, fx - cellX, fz - cellZ, normal);
+    return true;
+}
+
+bool Heightfield::getMaxHeight(float minX, float minZ, float maxX, float maxZ, float& height, Vec3* point) const {
+    if (empty()) return false;
+    float x0 = std::max((minX - origin.x) / cellSize, 0.0f);
+    float x1 = std::min((maxX - origin.x) / cellSize, (float)(width - 1));
+    float z0 = std::max((minZ - origin.z) / cellSize, 0.0f);
+    float z1 = std::min((maxZ - origin.z) / cellSize, (float)(depth - 1));
+    if (!(x0 <= x1 && z0 <= z1)) return false;
+
+    // The surface over a clipped cell is two planes, so its highest point is a corner of the clipped
+    // cell or where the diagonal crosses the clipped cell's border
+    const Level& cells = levels[0];
+    height = -std::numeric_limits<float>::infinity();
+    for (int z = std::min((int)z0, depth - 2); z <= std::min((int)z1, depth - 2); z++) {
+        for (int x = std::min((int)x0, width - 2); x <= std::min((int)x1, width - 2); x++) {
+            if (cells.maxHeights[(size_t)z * cells.width + x] <= height) continue;
+
+            float u0 = std::max(x0 - x, 0.0f), u1 = std::min(x1 - x, 1.0f);
+            float v0 = std::max(z0 - z, 0.0f), v1 = std::min(z1 - z, 1.0f);
+            float candidates[8][2] = { { u0, v0 }, { u1, v0 }, { u0, v1 }, { u1, v1 } };
+            int count = 4;
+            if (u0 >= v0 && u0 <= v1) { candidates[count][0] = u0; candidates[count++][1] = u0; }
+            if (u1 >= v0 && u1 <= v1) { candidates[count][0] = u1; candidates[count++][1] = u1; }
+            if (v0 >= u0 && v0 <= u1) { candidates[count][0] = v0; candidates[count++][1] = v0; }
+            if (v1 >= u0 && v1 <= u1) { candidates[count][0] = v1; candidates[count++][1] = v1; }
+            for (int i = 0; i < count; i++) {
+                float h = cellHeight(x, z, candidates[i][0], candidates[i][1], nullptr);
+                if (h > height) {
+                    height = h;
+                    if (point) *point = Vec3(origin.x + (x + candidates[i][0]) * cellSize, h,
+                                             origin.z + (z + candidates[i][1]) * cellSize);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool Heightfield::raycast(const Vec3& start, const Vec3& direction, float maxT, HeightfieldHit& hit) const {
+    if (empty() || !(maxT >= 0.0f)) return false;
+
+    // Starting under the surface is a hit straight away
+    float height;
+    Vec3 normal;
+    if (getHeight(start.x, start.z, height, &normal) && start.y <= height) {
+        hit.t = 0.0f;
+        hit.point = start;
+        hit.normal = normal;
+        return true;
+    }
+
+    float tMin = 0.0f, tMax = maxT;
+    AABB bounds = getBounds();
+    if (!clipSlab(start.x, direction.x, bounds.min.x, bounds.max.x, tMin, tMax) ||
+        !clipSlab(start.z, direction.z, bounds.min.z, bounds.max.z, tMin, tMax)) {
+        return false;
+    }
+    return raycastNode((int)levels.size() - 1, 0, 0, start, direction, tMin, tMax, hit);
+}
+
+bool Heightfield::raycastNode(int level, int x, int z, const Vec3& start, const Vec3& direction, float tMin,
+                              float tMax, HeightfieldHit& hit) const {
+    const Level& node = levels[level];
+    if (x >= node.width || z >= node.depth) return false;
+
+    // Part of the ray over the block, skipped if it stays above the block's highest point
+    float minX = origin.x + (float)(x << level) * cellSize;
+    float maxX = origin.x + (float)std::min((x + 1) << level, width - 1) * cellSize;
+    float minZ = origin.z + (float)(z << level) * cellSize;
+    float maxZ = origin.z + (float)std::min((z + 1) << level, depth - 1) * cellSize;
+    if (!clipSlab(start.x, direction.x, minX, maxX, tMin, tMax) ||
+        !clipSlab(start.z, direction.z, minZ, maxZ, tMin, tMax)) {
+        return false;
+    }
+    float lowest = std::min(start.y + direction.y * tMin, start.y + direction.y * tMax);
+    if (lowest > node.maxHeights[(size_t)z * node.width + x]) return false;
+
+    if (level == 0) return raycastCell(x, z, start, direction, tMin, tMax, hit);
+
+    // A ray crosses at most three of the four children, nearest first going by its direction
+    int stepX = direction.x < 0.0f ? 1 : 0;
+    int stepZ = direction.z < 0.0f ? 1 : 0;
+    const int order[4][2] = { { stepX, stepZ }, { 1 - stepX, stepZ }, { stepX, 1 - stepZ }, { 1 - stepX, 1 - stepZ } };
+    for (const auto& child : order) {
+        if (raycastNode(level - 1, x * 2 + child[0], z * 2 + child[1], start, direction, tMin, tMax, hit)) return true;
+    }
+    return false;
+}
+
+bool Heightfield::raycastCell(int x, int z, const Vec3& start, const Vec3& direction, float tMin, float tMax,
+                              HeightfieldHit& hit) const {
+    // Fractions across the cell along the ray
+    auto u = [&](float t) { return (start.x + direction.x * t - origin.x) / cellSize - x; };
+    auto v = [&](float t) { return (start.z + direction.z * t - origin.z) / cellSize - z; };
+    auto above = [&](float t) { return start.y + direction.y * t - cellHeight(x, z, u(t), v(t), nullptr); };
+
+    // The height along the ray is linear on either side of where it crosses the diagonal
+    float breaks[3] = { tMin, tMax, tMax };
+    int count = 2;
+    float across = (direction.x - direction.z) / cellSize;
+    if (across != 0.0f) {
+        float tDiagonal = -(u(0.0f) - v(0.0f)) / across;
+        if (tDiagonal > tMin && tDiagonal < tMax) {
+            breaks[1] = tDiagonal;
+            count = 3;
+        }
+    }
+
+    for (int i = 0; i + 1 < count; i++) {
+        float t0 = breaks[i], t1 = breaks[i + 1];
+        float gap0 = above(t0), gap1 = above(t1);
+        if (gap0 > 0.0f && gap1 > 0.0f) continue;
+
+        float t = gap0 <= 0.0f ? t0 : t0 + (t1 - t0) * gap0 / (gap0 - gap1);
+        float middle = (t0 + t1) * 0.5f;
+        cellHeight(x, z, u(middle), v(middle), &hit.normal);
+        hit.t = t;
+        hit.point = start + direction * t;
+        return true;
+    }
+    return false;
+}
+
+bool Heightfield::sweep(const AABB& box, const Vec3& direction, float maxT, HeightfieldHit& hit) const {
+    if (empty() || !(maxT >= 0.0f)) return false;
+
+    auto touches = [&](float t, Vec3* point) {
+        Vec3 offset = direction * t;
+        float height;
+        return getMaxHeight(box.min.x + offset.x, box.min.z + offset.z, box.max.x + offset.x, box.max.z + offset.z,
+                            height, point) && height >= box.min.y + offset.y;
+    };
+
+    // Only the stretch where the box is over the field and low enough can touch it
+    Vec3 size = box.max - box.min;
+    AABB bounds = getBounds();
+    float tMin = 0.0f, tMax = maxT;
+    if (!clipSlab(box.min.x, direction.x, bounds.min.x - size.x, bounds.max.x, tMin, tMax) ||
+        !clipSlab(box.min.z, direction.z, bounds.min.z - size.z, bounds.max.z, tMin, tMax) ||
+        !clipSlab(box.min.y, direction.y, -std::numeric_limits<float>::infinity(), bounds.max.y, tMin, tMax)) {
+        return false;
+    }
+
+    float across = std::sqrt(direction.x * direction.x + direction.z * direction.z);
+    float step = across > 0.0f ? 0.5f * cellSize / across : tMax - tMin;
+    Vec3 point;
+    float before = tMin;
+    bool found = touches(tMin, &point);
+    float t = tMin;
+    while (!found && t < tMax) {
+        before = t;
+        t = std::min(t + step, tMax);
+        found = touches(t, &point);
+    }
+    if (!found) return false;
+
+    // Narrow down between the last free position and the first touching one
+    if (t > tMin) {
+        for (int i = 0; i < 16; i++) {
+            float middle = (before + t) * 0.5f;
+            if (touches(middle, &point)) t = middle;
+            else before = middle;
+        }
+        touches(t, &point);
+    }
+
+    hit.t = t;
+    hit.point = box.min + direction * t;
+    float height;
+    getHeight(point.x, point.z, height, &hit.normal);
+    return true;
+}
+
+bool Heightfield::overlaps(const AABB& box) const {
+    float height;
+    return getMaxHeight(box.min.x, box.min.z, box.max.x, box.max.z, height) && height >= box.min.y;
+}
+
+bool Heightfield::overlaps(const Vec3& center, float radius) const {
+    if (empty() || !(radius >= 0.0f)) return false;
+
+    float height;
+    if (getHeight(center.x, center.z, height) && center.y <= height) return true;
+
+    float x0 = std::max((center.x - radius - origin.x) / cellSize, 0.0f);
+    float x1 = std::min((center.x + radius - origin.x) / cellSize, (float)(width - 1));
+    float z0 = std::max((center.z - radius - origin.z) / cellSize, 0.0f);
+    float z1 = std::min((center.z + radius - origin.z) / cellSize, (float)(depth - 1));
+    if (!(x0 <= x1 && z0 <= z1)) return false;
+
+    const Level& cells = levels[0];
+    for (int z = std::min((int)z0, depth - 2); z <= std::min((int)z1, depth - 2); z++) {
+        for (int x = std::min((int)x0, width - 2); x <= std::min((int)x1, width - 2); x++) {
+            if (cells.maxHeights[(size_t)z * cells.width + x] < center.y - radius) continue;
+
+            auto corner = [&](int dx, int dz) {
+                return Vec3(origin.x + (x + dx) * cellSize, getSample(x + dx, z + dz), origin.z + (z + dz) * cellSize);
+            };
+            Vec3 a = corner(0, 0), b = corner(1, 0), c = corner(0, 1), d = corner(1, 1);
+            for (const Vec3& closest : { closestPointOnTriangle(center, a, b, d), closestPointOnTriangle(center, a, d, c) }) {
+                if (dot(closest - center, closest - center) <= radius * radius) return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,22 @@
+#include "physics/PhysicsLOD.h"
+#include <cmath>
+#include <algorithm>
+
+int selectLODBand(const std::vector<PhysicsLODBand>& bands, float distance, int current, float hysteresis) {
+    if (bands.empty()) return 0;
+    int band = std::max(0, std::min(current, (int)bands.size() - 1));
+    while (band + 1 < (int)bands.size() && distance > bands[band + 1].distance * (1.0f + hysteresis)) band++;
+    while (band > 0 && distance < bands[band].distance * (1.0f - hysteresis)) band--;
+    return band;
+}
+
+uint32_t lodPhase(const Vec3& position, int interval) {
+    if (interval <= 1) return 0;
+
+    // Columns of 16 x 16 units, the phase is a hash of the column
+    const float regionSize = 16.0f;
+    int32_t x = (int32_t)std::floor(position.x / regionSize);
+    int32_t z = (int32_t)std::floor(position.z / regionSize);
+    uint32_t hash = ((uint32_t)x * 73856093u) ^ ((uint32_t)z * 19349663u);
+    return hash % (uint32_t)interval;
+}
@@ -0,0 +1,16 @@
+#include "physics/PhysicsStats.h"
+
+void writeStatsCSV(std::ostream& out, const std::vector<PhysicsStats>& steps) {
+    out << "step,awake_bodies,stepped_bodies,simplified_bodies,sleeping_bodies,colliders,static_cubes,moves,broadphase_candidates,"
+           "narrowphase_tests,substepped_bodies,collisions,body_contacts,solver_contacts,solver_islands,"
+           "solver_iterations,sync_ms,integrate_ms,solve_ms,collide_ms,write_back_ms,contacts_ms,islands_ms,total_ms\n";
+    for (const PhysicsStats& s : steps) {
+        out << s.step << ',' << s.awakeBodies << ',' << s.steppedBodies << ',' << s.simplifiedBodies << ','
+            << s.sleepingBodies << ',' << s.colliders << ','
+            << s.staticCubes << ',' << s.moves << ',' << s.broadphaseCandidates << ',' << s.narrowphaseTests << ','
+            << s.substeppedBodies << ',' << s.collisions << ',' << s.bodyContacts << ','
+            << s.solverContacts << ',' << s.solverIslands << ',' << s.solverIterations << ','
+            << s.syncMs << ',' << s.integrateMs << ',' << s.solveMs << ',' << s.collideMs << ',' << s.writeBackMs << ','
+            << s.contactsMs << ',' << s.islandsMs << ',' << s.totalMs << '\n';
+    }
+}
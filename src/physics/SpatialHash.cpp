@@ -0,0 +1,189 @@
+#include "physics/SpatialHash.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+uint64_t SpatialHash::cellKey(int x, int y, int z) {
+    // 21 bits per axis is plenty for game worlds
+    const uint64_t mask = (1ull << 21) - 1;
+    return ((uint64_t)x & mask) | (((uint64_t)y & mask) << 21) | (((uint64_t)z & mask) << 42);
+}
+
+// Cell coordinate of a world coordinate, clamped to the 21 bits cellKey keeps
+static int toCell(float value, float inverseCellSize) {
+    const float limit = (float)((1 << 20) - 1);
+    return (int)std::fmax(-limit, std::fmin(limit, std::floor(value * inverseCellSize)));
+}
+
+SpatialHash::CellRange SpatialHash::getCellRange(const AABB& bounds) const {
+    return {
+        toCell(bounds.min.x, inverseCellSize),
+        toCell(bounds.min.y, inverseCellSize),
+        toCell(bounds.min.z, inverseCellSize),
+        toCell(bounds.max.x, inverseCellSize),
+        toCell(bounds.max.y, inverseCellSize),
+        toCell(bounds.max.z, inverseCellSize),
+    };
+}
+
+void SpatialHash::addToCells(uint32_t proxy, const CellRange& range) {
+    for (int x = range.minX; x <= range.maxX; x++) {
+        for (int y = range.minY; y <= range.maxY; y++) {
+            for (int z = range.minZ; z <= range.maxZ; z++) {
+                cells[cellKey(x, y, z)].push_back(proxy);
+            }
+        }
+    }
+}
+
+void SpatialHash::removeFromCells(uint32_t proxy, const CellRange& range) {
+    for (int x = range.minX; x <= range.maxX; x++) {
+        for (int y = range.minY; y <= range.maxY; y++) {
+            for (int z = range.minZ; z <= range.maxZ; z++) {
+                auto it = cells.find(cellKey(x, y, z));
+                if (it == cells.end()) continue;
+
+                auto& cell = it->second;
+                for (size_t i = 0; i < cell.size(); i++) {
+                    if (cell[i] == proxy) {
+                        cell[i] = cell.back();
+                        cell.pop_back();
+                        break;
+                    }
+                }
+                if (cell.empty()) cells.erase(it);
+            }
+        }
+    }
+}
+
+void SpatialHash::update(Entity entity, const AABB& bounds) {
+    CellRange range = getCellRange(bounds);
+
+    auto it = proxyIndices.find(entity);
+    if (it == proxyIndices.end()) {
+        uint32_t index = proxies.size();
+        proxies.push_back({ entity, bounds, range });
+        proxyIndices[entity] = index;
+        addToCells(index, range);
+        return;
+    }
+
+    // Only touch the cells if the entity moved into different ones
+    Proxy& proxy = proxies[it->second];
+    proxy.bounds = bounds;
+    if (proxy.cells == range) return;
+
+    removeFromCells(it->second, proxy.cells);
+    proxy.cells = range;
+    addToCells(it->second, range);
+}
+
+void SpatialHash::remove(Entity entity) {
+    auto it = proxyIndices.find(entity);
+    if (it == proxyIndices.end()) return;
+
+    uint32_t index = it->second;
+    removeFromCells(index, proxies[index].cells);
+    proxyIndices.erase(it);
+
+    // Move the last proxy into the hole and patch its cell entries
+    uint32_t last = proxies.size() - 1;
+    if (index != last) {
+        removeFromCells(last, proxies[last].cells);
+        proxies[index] = proxies[last];
+        proxyIndices[proxies[index].entity] = index;
+        addToCells(index, proxies[index].cells);
+    }
+    proxies.pop_back();
+}
+
+void SpatialHash::setLayers(Entity entity, uint32_t layers) {
+    auto it = proxyIndices.find(entity);
+    if (it != proxyIndices.end()) proxies[it->second].layers = layers;
+}
+
+void SpatialHash::query(const AABB& bounds, std::vector<Entity>& result, uint32_t layerMask) const {
+    CellRange range = getCellRange(bounds);
+
+    for (int x = range.minX; x <= range.maxX; x++) {
+        for (int y = range.minY; y <= range.maxY; y++) {
+            for (int z = range.minZ; z <= range.maxZ; z++) {
+                auto it = cells.find(cellKey(x, y, z));
+                if (it == cells.end()) continue;
+
+                for (uint32_t index : it->second) {
+                    const Proxy& proxy = proxies[index];
+                    if (!(proxy.layers & layerMask)) continue;
+                    // A proxy spanning several cells is only reported from the first one both ranges share
+                    if (x != std::max(range.minX, proxy.cells.minX) ||
+                        y != std::max(range.minY, proxy.cells.minY) ||
+                        z != std::max(range.minZ, proxy.cells.minZ)) continue;
+                    if (overlaps(proxy.bounds, bounds)) result.push_back(proxy.entity);
+                }
+            }
+        }
+    }
+}
+
+void SpatialHash::raycast(const Vec3& origin, const Vec3& direction, float maxT, std::vector<Entity>& result,
+                          uint32_t layerMask) const {
+    // maxT bounds the walk, an endless ray would never leave the grid
+    if (!(maxT >= 0.0f) || std::isinf(maxT)) return;
+
+    const Vec3 end = origin + direction * maxT;
+    const float start[3] = { origin.x * inverseCellSize, origin.y * inverseCellSize, origin.z * inverseCellSize };
+    const float dir[3] = { direction.x * inverseCellSize, direction.y * inverseCellSize, direction.z * inverseCellSize };
+    int cell[3] = { toCell(origin.x, inverseCellSize), toCell(origin.y, inverseCellSize), toCell(origin.z, inverseCellSize) };
+    const int last[3] = { toCell(end.x, inverseCellSize), toCell(end.y, inverseCellSize), toCell(end.z, inverseCellSize) };
+
+    // Ray parameter of the next cell boundary on each axis and the distance between boundaries, as in VoxelGrid
+    float tMax[3], tDelta[3];
+    for (int axis = 0; axis < 3; axis++) {
+        float floored = std::floor(start[axis]);
+        if (dir[axis] > 0) {
+            tDelta[axis] = 1.0f / dir[axis];
+            tMax[axis] = (floored + 1.0f - start[axis]) * tDelta[axis];
+        } else if (dir[axis] < 0) {
+            tDelta[axis] = -1.0f / dir[axis];
+            tMax[axis] = (start[axis] - floored) * tDelta[axis];
+        } else {
+            tDelta[axis] = tMax[axis] = std::numeric_limits<float>::infinity();
+        }
+    }
+
+    Vec3 inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    size_t first = result.size();
+    while (true) {
+        auto it = cells.find(cellKey(cell[0], cell[1], cell[2]));
+        if (it != cells.end()) {
+            for (uint32_t index : it->second) {
+                const Proxy& proxy = proxies[index];
+                if ((proxy.layers & layerMask) && rayOverlaps(proxy.bounds, origin, inverseDirection, maxT)) {
+                    result.push_back(proxy.entity);
+                }
+            }
+        }
+
+        // Step across the nearest boundary of an axis that hasn't reached the last cell yet,
+        // so rounding can't walk past the end of the segment
+        int axis = -1;
+        for (int i = 0; i < 3; i++) {
+            if (cell[i] != last[i] && (axis == -1 || tMax[i] < tMax[axis])) axis = i;
+        }
+        if (axis == -1) break;
+
+        cell[axis] += (last[axis] > cell[axis]) ? 1 : -1;
+        tMax[axis] += tDelta[axis];
+    }
+
+    // Entities spanning several cells were found once per cell
+    std::sort(result.begin() + first, result.end());
+    result.erase(std::unique(result.begin() + first, result.end()), result.end());
+}
+
+void SpatialHash::clear() {
+    proxies.clear();
+    proxyIndices.clear();
+    cells.clear();
+}
@@ -0,0 +1,108 @@
+#include "physics/Triangle.h"
+#include <cmath>
+#include <algorithm>
+
+// Ericson, Real-Time Collision Detection 5.1.5
+Vec3 closestPointOnTriangle(const Vec3& p, const Vec3& a, const Vec3& b, const Vec3& c) {
+    Vec3 ab = b - a, ac = c - a, ap = p - a;
+    float d1 = dot(ab, ap), d2 = dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) return a;
+
+    Vec3 bp = p - b;
+    float d3 = dot(ab, bp), d4 = dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) return b;
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return a + ab * (d1 / (d1 - d3));
+
+    Vec3 cp = p - c;
+    float d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) return c;
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return a + ac * (d2 / (d2 - d6));
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    float denominator = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+// Möller-Trumbore
+bool rayTriangle(const Vec3& origin, const Vec3& direction, float maxT, const Vec3& a, const Vec3& b, const Vec3& c,
+                 float& t) {
+    Vec3 edge1 = b - a, edge2 = c - a;
+    Vec3 p = cross(direction, edge2);
+    float determinant = dot(edge1, p);
+    if (std::fabs(determinant) < 1e-12f) return false; // parallel
+
+    float inverse = 1.0f / determinant;
+    Vec3 s = origin - a;
+    float u = dot(s, p) * inverse;
+    if (u < 0.0f || u > 1.0f) return false;
+
+    Vec3 q = cross(s, edge1);
+    float v = dot(direction, q) * inverse;
+    if (v < 0.0f || u + v > 1.0f) return false;
+
+    t = dot(edge2, q) * inverse;
+    return t > 0.0f && t <= maxT;
+}
+
+bool sweepBoxTriangle(const AABB& box, const Vec3& move, const Vec3& a, const Vec3& b, const Vec3& c,
+                      float& t, Vec3& normal) {
+    Vec3 center = (box.min + box.max) * 0.5f;
+    Vec3 extent = (box.max - box.min) * 0.5f;
+    Vec3 edges[3] = { b - a, c - b, a - c };
+    Vec3 faceNormal = cross(edges[0], edges[1]);
+    if (dot(faceNormal, faceNormal) < 1e-20f) return false; // degenerate
+    const Vec3 boxAxes[3] = { Vec3(1, 0, 0), Vec3(0, 1, 0), Vec3(0, 0, 1) };
+
+    Vec3 axes[13] = { boxAxes[0], boxAxes[1], boxAxes[2], faceNormal };
+    int count = 4;
+    for (const Vec3& boxAxis : boxAxes) {
+        for (const Vec3& edge : edges) axes[count++] = cross(boxAxis, edge);
+    }
+
+    // Every axis bounds the times the projections overlap, the box touches once all of them do
+    float tFirst = 0.0f, tLast = 1.0f;
+    bool entered = false;
+    for (int i = 0; i < count; i++) {
+        const Vec3& axis = axes[i];
+        float lengthSquared = dot(axis, axis);
+        if (lengthSquared < 1e-12f) continue; // edge along a box axis, covered by the box axes
+
+        float radius = extent.x * std::fabs(axis.x) + extent.y * std::fabs(axis.y) + extent.z * std::fabs(axis.z);
+        float boxMin = dot(center, axis) - radius, boxMax = dot(center, axis) + radius;
+        float pa = dot(a, axis), pb = dot(b, axis), pc = dot(c, axis);
+        float triangleMin = std::min({ pa, pb, pc }), triangleMax = std::max({ pa, pb, pc });
+
+        float speed = dot(move, axis);
+        if (speed == 0.0f) {
+            if (boxMax < triangleMin || boxMin > triangleMax) return false;
+            continue;
+        }
+        float t0 = (triangleMin - boxMax) / speed;
+        float t1 = (triangleMax - boxMin) / speed;
+        if (t0 > t1) std::swap(t0, t1);
+        if (t0 > tFirst) {
+            tFirst = t0;
+            normal = axis * ((speed > 0.0f ? -1.0f : 1.0f) / std::sqrt(lengthSquared));
+            entered = true;
+        }
+        tLast = std::min(tLast, t1);
+        if (tFirst > tLast) return false;
+    }
+
+    // Touching from the start, push back against the move, or out through the face
+    if (!entered) {
+        normal = normalise(faceNormal);
+        float towardsBox = dot(move, move) > 0.0f ? -dot(move, normal) : dot(center - a, normal);
+        if (towardsBox < 0.0f) normal = -normal;
+    }
+    t = tFirst;
+    return true;
+}
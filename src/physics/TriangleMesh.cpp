@@ -0,0 +1,366 @@
+#include "physics/TriangleMesh.h"
+#include "physics/Triangle.h"
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+
+// Deeper trees only come from degenerate meshes, the rest of such a branch becomes one leaf
+static constexpr int MAX_DEPTH = 60;
+static constexpr int MAX_LEAF_SIZE = 8;
+static constexpr int BIN_COUNT = 16;
+
+// Ray entry time into a node's box, false if the segment t in [0, maxT] misses it
+static bool rayEntry(const Vec3& min, const Vec3& max, const Vec3& origin, const Vec3& inverseDirection, float maxT,
+                     float& tEntry) {
+    const float boxMin[3] = { min.x, min.y, min.z };
+    const float boxMax[3] = { max.x, max.y, max.z };
+    const float start[3] = { origin.x, origin.y, origin.z };
+    const float inverse[3] = { inverseDirection.x, inverseDirection.y, inverseDirection.z };
+
+    float tMin = 0.0f, tMax = maxT;
+    for (int axis = 0; axis < 3; axis++) {
+        float t1 = (boxMin[axis] - start[axis]) * inverse[axis];
+        float t2 = (boxMax[axis] - start[axis]) * inverse[axis];
+        // NaN means the ray runs along a slab plane, which doesn't constrain t
+        if (std::isnan(t1) || std::isnan(t2)) continue;
+
+        tMin = std::max(tMin, std::min(t1, t2));
+        tMax = std::min(tMax, std::max(t1, t2));
+        if (tMin > tMax) return false;
+    }
+    tEntry = tMin;
+    return true;
+}
+
+static float distanceSquared(const Vec3& p, const Vec3& min, const Vec3& max) {
+    Vec3 closest = maxVec(min, minVec(p, max));
+    return dot(closest - p, closest - p);
+}
+
+static Vec3 faceNormal(const Vec3& a, const Vec3& b, const Vec3& c) {
+    return normalise(cross(b - a, c - a));
+}
+
+TriangleMesh::TriangleMesh(std::shared_ptr<Shape> shape) : shape(std::move(shape)) {
+    const std::vector<Vertex>& vertices = this->shape->getVertices();
+    const std::vector<GLushort>& indices = this->shape->getIndices();
+    vertexData = (const uint8_t*)vertices.data() + offsetof(Vertex, position);
+    vertexStride = sizeof(Vertex);
+
+    if (indices.empty()) {
+        for (uint32_t i = 0; i + 2 < vertices.size(); i += 3) triangles.insert(triangles.end(), { i, i + 1, i + 2 });
+    } else {
+        triangles.assign(indices.begin(), indices.end() - indices.size() % 3);
+    }
+    build();
+}
+
+TriangleMesh::TriangleMesh(std::vector<Vec3> positions, const std::vector<uint32_t>& indices)
+    : positions(std::move(positions)) {
+    vertexData = (const uint8_t*)this->positions.data();
+    vertexStride = sizeof(Vec3);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        if (indices[i] >= this->positions.size() || indices[i + 1] >= this->positions.size() ||
+            indices[i + 2] >= this->positions.size()) {
+            continue;
+        }
+        triangles.insert(triangles.end(), { indices[i], indices[i + 1], indices[i + 2] });
+    }
+    build();
+}
+
+void TriangleMesh::build() {
+    uint32_t count = (uint32_t)(triangles.size() / 3);
+    nodes.clear();
+    if (!count) return;
+
+    std::vector<AABB> bounds(count);
+    std::vector<Vec3> centroids(count);
+    std::vector<uint32_t> order(count);
+    for (uint32_t i = 0; i < count; i++) {
+        Vec3 a, b, c;
+        getTriangle(i, a, b, c);
+        bounds[i] = { minVec(a, minVec(b, c)), maxVec(a, maxVec(b, c)) };
+        centroids[i] = (a + b + c) / 3.0f;
+        order[i] = i;
+    }
+
+    // A binary tree over n leaves of at least one triangle has at most 2n - 1 nodes, so references
+    // into 'nodes' stay valid while children are added
+    nodes.reserve(2 * (size_t)count);
+    nodes.push_back({ Vec3(), 0, Vec3(), count });
+
+    struct Pending {
+        uint32_t node;
+        int depth;
+    };
+    std::vector<Pending> pending = { { 0, 0 } };
+    while (!pending.empty()) {
+        Pending current = pending.back();
+        pending.pop_back();
+        Node& node = nodes[current.node];
+        uint32_t first = node.first, size = node.count;
+
+        AABB box = bounds[order[first]];
+        AABB centroidBox = { centroids[order[first]], centroids[order[first]] };
+        for (uint32_t i = first + 1; i < first + size; i++) {
+            box = merge(box, bounds[order[i]]);
+            centroidBox = merge(centroidBox, { centroids[order[i]], centroids[order[i]] });
+        }
+        node.min = box.min;
+        node.max = box.max;
+        if (size <= 2 || current.depth >= MAX_DEPTH) continue;
+
+        // Binned surface area heuristic over all three axes. A split costs one traversal step plus its
+        // children's triangles weighted by the chance a ray through the node hits them.
+        float bestCost = std::numeric_limits<float>::infinity();
+        int bestAxis = -1, bestSplit = 0;
+        const float boxMin[3] = { centroidBox.min.x, centroidBox.min.y, centroidBox.min.z };
+        const float boxMax[3] = { centroidBox.max.x, centroidBox.max.y, centroidBox.max.z };
+        for (int axis = 0; axis < 3; axis++) {
+            float extent = boxMax[axis] - boxMin[axis];
+            if (!(extent > 0.0f)) continue;
+            float scale = BIN_COUNT / extent;
+
+            uint32_t binCounts[BIN_COUNT] = {};
+            AABB binBounds[BIN_COUNT];
+            for (uint32_t i = first; i < first + size; i++) {
+                const Vec3& centroid = centroids[order[i]];
+                float position = axis == 0 ? centroid.x : (axis == 1 ? centroid.y : centroid.z);
+                int bin = std::min(BIN_COUNT - 1, (int)((position - boxMin[axis]) * scale));
+                binBounds[bin] = binCounts[bin] ? merge(binBounds[bin], bounds[order[i]]) : bounds[order[i]];
+                binCounts[bin]++;
+            }
+
+            // Costs of everything left of each split plane, then sweep back from the right
+            float leftCosts[BIN_COUNT - 1];
+            AABB sweep;
+            uint32_t swept = 0;
+            for (int i = 0; i < BIN_COUNT - 1; i++) {
+                if (binCounts[i]) sweep = swept ? merge(sweep, binBounds[i]) : binBounds[i];
+                swept += binCounts[i];
+                leftCosts[i] = swept ? swept * surfaceArea(sweep) : 0.0f;
+            }
+            swept = 0;
+            for (int i = BIN_COUNT - 1; i > 0; i--) {
+                if (binCounts[i]) sweep = swept ? merge(sweep, binBounds[i]) : binBounds[i];
+                swept += binCounts[i];
+                if (!swept || swept == size) continue;
+                float cost = leftCosts[i - 1] + swept * surfaceArea(sweep);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = i;
+                }
+            }
+        }
+
+        float area = surfaceArea(box);
+        float splitCost = area > 0.0f ? 1.0f + bestCost / area : std::numeric_limits<float>::infinity();
+        if (bestAxis < 0 || (splitCost >= size && size <= MAX_LEAF_SIZE)) continue;
+
+        float scale = BIN_COUNT / (boxMax[bestAxis] - boxMin[bestAxis]);
+        auto middle = std::partition(order.begin() + first, order.begin() + first + size, [&](uint32_t i) {
+            float position = bestAxis == 0 ? centroids[i].x : (bestAxis == 1 ? centroids[i].y : centroids[i].z);
+            return std::min(BIN_COUNT - 1, (int)((position - boxMin[bestAxis]) * scale)) < bestSplit;
+        });
+        uint32_t leftCount = (uint32_t)(middle - (order.begin() + first));
+        if (leftCount == 0 || leftCount == size) continue;
+
+        uint32_t left = (uint32_t)nodes.size();
+        node.first = left;
+        node.count = 0;
+        nodes.push_back({ Vec3(), first, Vec3(), leftCount });
+        nodes.push_back({ Vec3(), first + leftCount, Vec3(), size - leftCount });
+        pending.push_back({ left, current.depth + 1 });
+        pending.push_back({ left + 1, current.depth + 1 });
+    }
+
+    std::vector<uint32_t> sorted(triangles.size());
+    for (uint32_t i = 0; i < count; i++) {
+        for (int k = 0; k < 3; k++) sorted[i * 3 + k] = triangles[order[i] * 3 + k];
+    }
+    triangles = std::move(sorted);
+}
+
+bool TriangleMesh::raycast(const Vec3& origin, const Vec3& direction, float maxT, MeshHit& hit) const {
+    if (nodes.empty() || !(maxT >= 0.0f)) return false;
+
+    Vec3 inverse(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    float best = maxT;
+    bool found = false;
+
+    uint32_t stack[MAX_DEPTH + 2];
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+        const Node& node = nodes[stack[--top]];
+        float tEntry;
+        if (!rayEntry(node.min, node.max, origin, inverse, best, tEntry)) continue;
+
+        if (node.count) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                Vec3 a, b, c;
+                getTriangle(i, a, b, c);
+                float t;
+                if (rayTriangle(origin, direction, best, a, b, c, t)) {
+                    best = t;
+                    hit.triangle = i;
+                    found = true;
+                }
+            }
+            continue;
+        }
+
+        // Nearer child on top of the stack
+        float tLeft, tRight;
+        const Node& left = nodes[node.first];
+        const Node& right = nodes[node.first + 1];
+        bool hitLeft = rayEntry(left.min, left.max, origin, inverse, best, tLeft);
+        bool hitRight = rayEntry(right.min, right.max, origin, inverse, best, tRight);
+        if (hitLeft && hitRight) {
+            stack[top++] = tLeft < tRight ? node.first + 1 : node.first;
+            stack[top++] = tLeft < tRight ? node.first : node.first + 1;
+        } else if (hitLeft || hitRight) {
+            stack[top++] = hitLeft ? node.first : node.first + 1;
+        }
+    }
+    if (!found) return false;
+
+    Vec3 a, b, c;
+    getTriangle(hit.triangle, a, b, c);
+    hit.t = best;
+    hit.point = origin + direction * best;
+    hit.normal = faceNormal(a, b, c);
+    if (dot(hit.normal, direction) > 0.0f) hit.normal = -hit.normal;
+    return true;
+}
+
+bool TriangleMesh::sweep(const AABB& box, const Vec3& direction, float maxT, MeshHit& hit) const {
+    if (nodes.empty() || !(maxT >= 0.0f)) return false;
+
+    // Nodes grown by the size of the box are entered by a ray from its min corner
+    Vec3 size = box.max - box.min;
+    Vec3 move = direction * maxT;
+    Vec3 inverse(1.0f / move.x, 1.0f / move.y, 1.0f / move.z);
+    float best = 1.0f;
+    bool found = false;
+
+    uint32_t stack[MAX_DEPTH + 2];
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+        const Node& node = nodes[stack[--top]];
+        float tEntry;
+        if (!rayEntry(node.min - size, node.max, box.min, inverse, best, tEntry)) continue;
+
+        if (node.count) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                Vec3 a, b, c, normal;
+                getTriangle(i, a, b, c);
+                float t;
+                if (sweepBoxTriangle(box, move, a, b, c, t, normal) && (!found || t < best)) {
+                    best = t;
+                    hit.triangle = i;
+                    hit.normal = normal;
+                    found = true;
+                }
+            }
+            continue;
+        }
+        stack[top++] = node.first;
+        stack[top++] = node.first + 1;
+    }
+    if (!found) return false;
+
+    hit.t = best * maxT;
+    hit.point = box.min + move * best;
+    return true;
+}
+
+bool TriangleMesh::closestPoint(const Vec3& p, float maxDistance, MeshHit& hit) const {
+    if (nodes.empty() || !(maxDistance >= 0.0f)) return false;
+
+    float best = maxDistance * maxDistance;
+    bool found = false;
+    Vec3 closest;
+
+    uint32_t stack[MAX_DEPTH + 2];
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+        const Node& node = nodes[stack[--top]];
+        if (distanceSquared(p, node.min, node.max) > best) continue;
+
+        if (node.count) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                Vec3 a, b, c;
+                getTriangle(i, a, b, c);
+                Vec3 point = closestPointOnTriangle(p, a, b, c);
+                float distance = dot(point - p, point - p);
+                if (distance <= best) {
+                    best = distance;
+                    closest = point;
+                    hit.triangle = i;
+                    found = true;
+                }
+            }
+            continue;
+        }
+
+        const Node& left = nodes[node.first];
+        const Node& right = nodes[node.first + 1];
+        bool leftFirst = distanceSquared(p, left.min, left.max) < distanceSquared(p, right.min, right.max);
+        stack[top++] = leftFirst ? node.first + 1 : node.first;
+        stack[top++] = leftFirst ? node.first : node.first + 1;
+    }
+    if (!found) return false;
+
+    // Away from the surface towards p, or the face normal on the side p is on when it lies on the surface
+    Vec3 a, b, c;
+    getTriangle(hit.triangle, a, b, c);
+    hit.t = std::sqrt(best);
+    hit.point = closest;
+    if (hit.t > 1e-6f) {
+        hit.normal = (p - closest) / hit.t;
+    } else {
+        hit.normal = faceNormal(a, b, c);
+    }
+    return true;
+}
+
+void TriangleMesh::query(const AABB& box, std::vector<uint32_t>& result) const {
+    if (nodes.empty()) return;
+
+    uint32_t stack[MAX_DEPTH + 2];
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+        const Node& node = nodes[stack[--top]];
+        if (!::overlaps(box, AABB(node.min, node.max))) continue;
+
+        if (node.count) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                Vec3 a, b, c, normal;
+                getTriangle(i, a, b, c);
+                float t;
+                if (sweepBoxTriangle(box, Vec3(0, 0, 0), a, b, c, t, normal)) result.push_back(i);
+            }
+            continue;
+        }
+        stack[top++] = node.first;
+        stack[top++] = node.first + 1;
+    }
+}
+
+bool TriangleMesh::overlaps(const AABB& box) const {
+    std::vector<uint32_t> found;
+    query(box, found);
+    return !found.empty();
+}
+
+bool TriangleMesh::overlaps(const Vec3& center, float radius) const {
+    MeshHit hit;
+    return closestPoint(center, radius, hit);
+}
@@ -0,0 +1,149 @@
+#include "physics/VoxelGrid.h"
+#include <cmath>
+#include <limits>
+
+uint64_t VoxelGrid::cellKey(int x, int y, int z) {
+    const uint64_t mask = (1ull << 21) - 1;
+    return ((uint64_t)x & mask) | (((uint64_t)y & mask) << 21) | (((uint64_t)z & mask) << 42);
+}
+
+uint64_t VoxelGrid::chunkKey(int x, int y, int z) {
+    return cellKey(x >> CHUNK_BITS, y >> CHUNK_BITS, z >> CHUNK_BITS);
+}
+
+bool VoxelGrid::toCell(const Vec3& position, int& x, int& y, int& z) {
+    const float tolerance = 1e-4f;
+    float rx = std::round(position.x), ry = std::round(position.y), rz = std::round(position.z);
+    if (std::fabs(position.x - rx) > tolerance || std::fabs(position.y - ry) > tolerance ||
+        std::fabs(position.z - rz) > tolerance) {
+        return false;
+    }
+
+    // Keep within the range cellKey can pack
+    const float limit = (float)(1 << 20);
+    if (std::fabs(rx) >= limit || std::fabs(ry) >= limit || std::fabs(rz) >= limit) return false;
+
+    x = (int)rx; y = (int)ry; z = (int)rz;
+    return true;
+}
+
+void VoxelGrid::set(int x, int y, int z, Entity entity) {
+    Chunk& chunk = chunks[chunkKey(x, y, z)];
+    int bit = bitIndex(x, y, z);
+    uint64_t& word = chunk.bits[bit >> 6];
+    uint64_t mask = 1ull << (bit & 63);
+    if (!(word & mask)) {
+        word |= mask;
+        chunk.count++;
+        cellCount++;
+    }
+    owners[cellKey(x, y, z)] = entity;
+}
+
+void VoxelGrid::erase(int x, int y, int z) {
+    auto it = chunks.find(chunkKey(x, y, z));
+    if (it == chunks.end()) return;
+
+    Chunk& chunk = it->second;
+    int bit = bitIndex(x, y, z);
+    uint64_t& word = chunk.bits[bit >> 6];
+    uint64_t mask = 1ull << (bit & 63);
+    if (!(word & mask)) return;
+
+    word &= ~mask;
+    cellCount--;
+    owners.erase(cellKey(x, y, z));
+    if (--chunk.count == 0) chunks.erase(it);
+}
+
+bool VoxelGrid::isSolid(int x, int y, int z) const {
+    auto it = chunks.find(chunkKey(x, y, z));
+    if (it == chunks.end()) return false;
+
+    int bit = bitIndex(x, y, z);
+    return (it->second.bits[bit >> 6] >> (bit & 63)) & 1;
+}
+
+Entity VoxelGrid::getEntity(int x, int y, int z) const {
+    auto it = owners.find(cellKey(x, y, z));
+    return it != owners.end() ? it->second : 0;
+}
+
+bool VoxelGrid::raycast(const Vec3& origin, const Vec3& direction, float maxT, VoxelHit& hit, bool skipStart) const {
+    // maxT bounds the walk, an endless ray would never stop in empty space
+    if (chunks.empty() || !(maxT >= 0.0f) || std::isinf(maxT)) return false;
+
+    const float infinity = std::numeric_limits<float>::infinity();
+    const float start[3] = { origin.x, origin.y, origin.z };
+    const float dir[3] = { direction.x, direction.y, direction.z };
+
+    int cell[3], step[3];
+    float tMax[3], tDelta[3];
+    for (int axis = 0; axis < 3; axis++) {
+        float floored = std::floor(start[axis]);
+        if (std::fabs(floored) >= (float)(1 << 20)) return false; // outside the grid
+        cell[axis] = (int)floored;
+
+        // Ray parameter of the first cell boundary on this axis, and the distance between boundaries
+        if (dir[axis] > 0) {
+            step[axis] = 1;
+            tDelta[axis] = 1.0f / dir[axis];
+            tMax[axis] = (floored + 1.0f - start[axis]) * tDelta[axis];
+        } else if (dir[axis] < 0) {
+            step[axis] = -1;
+            tDelta[axis] = -1.0f / dir[axis];
+            tMax[axis] = (start[axis] - floored) * tDelta[axis];
+        } else {
+            step[axis] = 0;
+            tDelta[axis] = tMax[axis] = infinity;
+        }
+    }
+
+    // Rays mostly stay in one chunk, remember the last one instead of hashing for every cell
+    uint64_t cachedKey = 0;
+    const Chunk* cachedChunk = nullptr;
+    bool cached = false;
+    auto solid = [&](int x, int y, int z) {
+        uint64_t key = chunkKey(x, y, z);
+        if (!cached || key != cachedKey) {
+            auto it = chunks.find(key);
+            cachedChunk = (it != chunks.end()) ? &it->second : nullptr;
+            cachedKey = key;
+            cached = true;
+        }
+        if (!cachedChunk) return false;
+        int bit = bitIndex(x, y, z);
+        return ((cachedChunk->bits[bit >> 6] >> (bit & 63)) & 1) != 0;
+    };
+
+    int enteredAxis = -1;
+    float t = 0.0f;
+    if (skipStart || !solid(cell[0], cell[1], cell[2])) {
+        while (true) {
+            // Step across the nearest cell boundary
+            int axis = (tMax[0] < tMax[1]) ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+            t = tMax[axis];
+            if (!(t <= maxT)) return false;
+
+            cell[axis] += step[axis];
+            tMax[axis] += tDelta[axis];
+            enteredAxis = axis;
+            if (solid(cell[0], cell[1], cell[2])) break;
+        }
+    }
+
+    hit.x = cell[0]; hit.y = cell[1]; hit.z = cell[2];
+    hit.t = t;
+    hit.normal = Vec3(0, 0, 0);
+    if (enteredAxis == 0) hit.normal.x = (float)-step[0];
+    if (enteredAxis == 1) hit.normal.y = (float)-step[1];
+    if (enteredAxis == 2) hit.normal.z = (float)-step[2];
+    hit.entity = getEntity(hit.x, hit.y, hit.z);
+    return true;
+}
+
+void VoxelGrid::clear() {
+    chunks.clear();
+    owners.clear();
+    cellCount = 0;
+}
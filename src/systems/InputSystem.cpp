@@ -1,4 +1,5 @@
 #include "systems/InputSystem.h"
+#include "core/Profiler.h"
 
 void InputSystem::processEvent(const Event& event, float deltaTime) {
     SDL_Scancode key;
@@ -11,6 +12,10 @@ void InputSystem::processEvent(const Event& event, float deltaTime) {
         if (key == SDL_SCANCODE_ESCAPE) {
             EventManager::getInstance().publish({EVENT_QUIT});
         }
+        // Dump the recorded profiler zones (only populated in PROFILE=1 builds)
+        if (key == SDL_SCANCODE_F2) {
+            Profiler::getInstance().exportChromeTrace("profile.json");
+        }
         break;
     case EVENT_KEYUP:
         key = event.castData<SDL_Scancode>();
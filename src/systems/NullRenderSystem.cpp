@@ -0,0 +1,18 @@
+#include "systems/NullRenderSystem.h"
+#include "core/Profiler.h"
+
+void NullRenderSystem::processEvent(const Event& event, float deltaTime) {
+
+}
+
+void NullRenderSystem::update(float deltaTime) {
+    PROFILE_ZONE("NullRenderSystem::prepare");
+    scene.update();
+    instanceCount = scene.getInstanceCount();
+    if (instances.size() < instanceCount) instances.resize(instanceCount);
+    scene.writeInstances(instances.data());
+
+    // Nothing to upload them to
+    scene.takeTextureUploads(textureUploads);
+    textureUploads.clear();
+}
@@ -1,73 +1,1166 @@
 #include "systems/PhysicsSystem.h"
 #include <limits>
+#include <algorithm>
+#include <cmath>
+#include "core/Profiler.h"
+#include "core/ThreadPool.h"
+#include <unordered_set>
+#include <fstream>
+#include <iostream>
+#include <mutex>
 
 constexpr float epsilon = 1e-5f; // Small tolerance for floating-point errors
 
+PhysicsSystem::PhysicsSystem(BroadphaseType broadphaseType) : broadphase(createBroadphase(broadphaseType)) {}
+
+void PhysicsSystem::setBroadphase(BroadphaseType type) {
+    broadphase = createBroadphase(type);
+
+    // The new broadphase is empty, its colliders are placed again with everything else
+    for (auto it = placements.begin(); it != placements.end();) {
+        it = it->second.kind == PLACED_COLLIDER ? placements.erase(it) : std::next(it);
+    }
+    colliderCount = 0;
+    registryVersion = UINT64_MAX;
+}
+
+bool PhysicsSystem::raycastBlocks(const Vec3& origin, const Vec3& direction, float maxDistance, VoxelHit& hit) {
+    // The grid is rebuilt lazily, make sure it reflects the current entities
+    if (registryVersion != registry.getVersion()) syncBroadphase();
+
+    float len = length(direction);
+    if (len <= 0.0f) return false;
+    return voxels.raycast(origin, direction / len, maxDistance, hit);
+}
+
 void PhysicsSystem::processEvent(const Event& event, float deltaTime) {
 
 }
 
-void PhysicsSystem::update(float deltaTime) {
-    entities = registry.getEntitiesWith(requiredComponents);
+void PhysicsSystem::syncBroadphase() {
+    PROFILE_ZONE("PhysicsSystem::syncBroadphase");
+    if (registryVersion != registry.getVersion()) {
+        // Only entities that were destroyed or had components added or removed are placed again. The
+        // first sync, and one the registry's log doesn't reach back far enough for, looks at all of them.
+        structureChanges.clear();
+        if (registryVersion == UINT64_MAX || !registry.getStructureChanges(registryVersion, structureChanges)) {
+            structureChanges.clear();
+            for (const auto& [entity, placement] : placements) structureChanges.push_back(entity);
+            std::vector<Entity> all = registry.getEntitiesWith(TRANSFORM_MASK);
+            structureChanges.insert(structureChanges.end(), all.begin(), all.end());
+        }
+        registryVersion = registry.getVersion();
+        std::sort(structureChanges.begin(), structureChanges.end());
+        structureChanges.erase(std::unique(structureChanges.begin(), structureChanges.end()), structureChanges.end());
+
+        removedBounds.clear();
+        for (Entity entity : structureChanges) unplace(entity);
+
+        // Sleeping bodies may have lost what they rest on, only the ones around it find out
+        for (const AABB& bounds : removedBounds) wakeTouching(bounds);
+
+        // Changed bodies are added back by place if they are still awake bodies
+        auto isChanged = [&](Entity entity) {
+            return std::binary_search(structureChanges.begin(), structureChanges.end(), entity);
+        };
+        awakeBodies.erase(std::remove_if(awakeBodies.begin(), awakeBodies.end(), isChanged), awakeBodies.end());
+        woken.erase(std::remove_if(woken.begin(), woken.end(), isChanged), woken.end());
+
+        for (Entity entity : structureChanges) place(entity);
+        return;
+    }
+
+    // Sleeping and static bodies don't move between structural changes
+    for (Entity entity : awakeBodies) {
+        broadphase->update(entity, getBounds(registry.getComponent<Transform>(entity).position));
+    }
+}
+
+void PhysicsSystem::unplace(Entity entity) {
+    // A sleeping body that is no longer one can't hold its island together
+    if (!registry.isAlive(entity) || !registry.match(entity, requiredComponents)) {
+        auto island = islandOf.find(entity);
+        if (island != islandOf.end()) wakeIsland(island->second);
+    }
+
+    auto it = placements.find(entity);
+    if (it == placements.end()) return;
+    const Placement& placement = it->second;
+    switch (placement.kind) {
+    case PLACED_COLLIDER:
+        broadphase->remove(entity);
+        colliderCount--;
+        break;
+    case PLACED_CUBE: {
+        // Another cube may have taken the cell over since
+        int x = (int)placement.bounds.min.x, y = (int)placement.bounds.min.y, z = (int)placement.bounds.min.z;
+        if (voxels.isSolid(x, y, z) && voxels.getEntity(x, y, z) == entity) voxels.erase(x, y, z);
+        cubeCount--;
+        break;
+    }
+    case PLACED_TERRAIN:
+        terrains.erase(std::find_if(terrains.begin(), terrains.end(),
+                                    [&](const Terrain& terrain) { return terrain.entity == entity; }));
+        break;
+    case PLACED_MESH:
+        meshes.erase(std::find_if(meshes.begin(), meshes.end(),
+                                  [&](const StaticMesh& mesh) { return mesh.entity == entity; }));
+        break;
+    }
+
+    // Even if it is placed again it may no longer hold anything up, e.g. a cube that became a body.
+    // A sleeping body that is removed wakes its own island above.
+    if (!placement.moving) removedBounds.push_back(placement.bounds);
+    placements.erase(it);
+}
+
+void PhysicsSystem::place(Entity entity) {
+    if (!registry.isAlive(entity) || !registry.match(entity, TRANSFORM_MASK)) return;
+
+    // Static cubes on integer coordinates go into the voxel grid, terrain and meshes into their own
+    // lists and everything else into the broadphase
+    Vec3 position = registry.getComponent<Transform>(entity).position;
+    Placement placement;
+    int x, y, z;
+    if (isStaticGeometry(entity)) {
+        const Collider& collider = registry.getComponent<Collider>(entity);
+        if (collider.heightfield) {
+            terrains.push_back({ entity, collider.heightfield, position, collider.layers });
+            placement = { PLACED_TERRAIN, collider.heightfield->getBounds() };
+        } else {
+            meshes.push_back({ entity, collider.mesh, position, collider.layers });
+            placement = { PLACED_MESH, collider.mesh->getBounds() };
+        }
+        placement.bounds = AABB(placement.bounds.min + position, placement.bounds.max + position);
+    } else if (!registry.match(entity, PHYSICS_MASK) && getLayers(entity) == COLLISION_LAYER_DEFAULT &&
+               VoxelGrid::toCell(position, x, y, z)) {
+        voxels.set(x, y, z, entity);
+        placement = { PLACED_CUBE, getBounds(position) };
+        cubeCount++;
+    } else {
+        broadphase->update(entity, getBounds(position));
+        broadphase->setLayers(entity, getLayers(entity));
+        placement = { PLACED_COLLIDER, getBounds(position) };
+        colliderCount++;
+    }
+    placement.moving = registry.match(entity, requiredComponents) && !registry.getComponent<Physics>(entity).isStatic &&
+                       !isStaticGeometry(entity);
+    placements[entity] = placement;
+
+    if (!registry.match(entity, requiredComponents)) return;
+    Physics& physics = registry.getComponent<Physics>(entity);
+    if (physics.isStatic || isStaticGeometry(entity)) return;
+    if (physics.isSleeping && islandOf.count(entity)) return;
+    physics.isSleeping = false;
+    awakeBodies.push_back(entity);
+}
+
+void PhysicsSystem::wake(Entity entity) {
+    auto it = islandOf.find(entity);
+    if (it != islandOf.end()) wakeIsland(it->second);
+}
+
+void PhysicsSystem::applyImpulse(Entity entity, const Vec3& impulse) {
+    if (!registry.isAlive(entity) || !registry.match(entity, requiredComponents)) return;
+
+    Physics& physics = registry.getComponent<Physics>(entity);
+    physics.velocity += (physics.mass > 0.0f) ? impulse / physics.mass : impulse;
+    physics.sleepTimer = 0.0f;
+    wake(entity);
+}
+
+void PhysicsSystem::wakeIsland(uint32_t island) {
+    for (Entity body : islands[island]) {
+        islandOf.erase(body);
+        if (!registry.isAlive(body) || !registry.match(body, requiredComponents)) continue;
+
+        Physics& physics = registry.getComponent<Physics>(body);
+        physics.isSleeping = false;
+        physics.sleepTimer = 0.0f;
+        woken.push_back(body);
+    }
+    islands[island].clear();
+    freeIslands.push_back(island);
+}
+
+void PhysicsSystem::wakeTouching(const AABB& bounds) {
+    nearby.clear();
+    broadphase->query(expand(bounds, contactMargin), nearby);
+    for (Entity entity : nearby) wake(entity);
+}
+
+void PhysicsSystem::updateIslands(float deltaTime) {
+    PROFILE_ZONE("PhysicsSystem::islands");
+
+    // Bodies woken during this step take part with a reset timer, so their islands stay awake
+    awakeBodies.insert(awakeBodies.end(), woken.begin(), woken.end());
+    woken.clear();
+
+    bodyIndex.clear();
+    islandParents.resize(awakeBodies.size());
+    for (uint32_t i = 0; i < awakeBodies.size(); i++) {
+        bodyIndex[awakeBodies[i]] = i;
+        islandParents[i] = i;
+    }
+
+    auto find = [&](uint32_t i) {
+        while (islandParents[i] != i) {
+            islandParents[i] = islandParents[islandParents[i]]; // path halving
+            i = islandParents[i];
+        }
+        return i;
+    };
+
+    // Union bodies that touched recently, forget old contacts and ones with a sleeping or removed body
+    for (auto it = contacts.begin(); it != contacts.end();) {
+        auto a = bodyIndex.find((Entity)(it->first >> 32));
+        auto b = bodyIndex.find((Entity)(it->first & 0xFFFFFFFF));
+        it->second += deltaTime;
+        if (it->second > timeToSleep || a == bodyIndex.end() || b == bodyIndex.end()) {
+            it = contacts.erase(it);
+            continue;
+        }
+        islandParents[find(a->second)] = find(b->second);
+        ++it;
+    }
+
+    // An island sleeps only if every body in it has rested long enough
+    std::vector<uint8_t> restless(awakeBodies.size(), 0);
+    for (uint32_t i = 0; i < awakeBodies.size(); i++) {
+        const Physics& physics = registry.getComponent<Physics>(awakeBodies[i]);
+        if (physics.sleepTimer < timeToSleep) restless[find(i)] = 1;
+    }
+
+    std::vector<int32_t> islandOfRoot(awakeBodies.size(), -1);
+    size_t kept = 0;
+    for (uint32_t i = 0; i < awakeBodies.size(); i++) {
+        Entity body = awakeBodies[i];
+        uint32_t root = find(i);
+        if (restless[root]) {
+            awakeBodies[kept++] = body;
+            continue;
+        }
+
+        if (islandOfRoot[root] == -1) {
+            if (freeIslands.empty()) {
+                islandOfRoot[root] = islands.size();
+                islands.emplace_back();
+            } else {
+                islandOfRoot[root] = freeIslands.back();
+                freeIslands.pop_back();
+            }
+        }
+
+        Physics& physics = registry.getComponent<Physics>(body);
+        physics.isSleeping = true;
+        physics.velocity = Vec3(0, 0, 0);
+        physics.lodTime = 0.0f;
+        islands[islandOfRoot[root]].push_back(body);
+        islandOf[body] = islandOfRoot[root];
+    }
+    awakeBodies.resize(kept);
+}
+
+void PhysicsSystem::selectSteppedBodies(float deltaTime, uint64_t step, PhysicsStats& current) {
+    steppedBodies.clear();
+    if (!lodCamera || lodBands.empty()) {
+        for (Entity entity : awakeBodies) {
+            Physics& physics = registry.getComponent<Physics>(entity);
+            physics.lodTime += deltaTime;
+            physics.lodBand = 0;
+        }
+        steppedBodies = awakeBodies;
+        current.steppedBodies = steppedBodies.size();
+        return;
+    }
 
-    for (const auto& entity : entities) {
-        Transform& transform = registry.getComponent<Transform>(entity);
+    Vec3 viewer = lodCamera->position;
+    for (Entity entity : awakeBodies) {
         Physics& physics = registry.getComponent<Physics>(entity);
+        Vec3 position = registry.getComponent<Transform>(entity).position;
+        physics.lodTime += deltaTime;
+
+        int band = selectLODBand(lodBands, length(position - viewer), physics.lodBand, lodHysteresis);
+        bool closer = band < physics.lodBand;
+        physics.lodBand = band;
+        if (lodBands[band].simplified) current.simplifiedBodies++;
+
+        // Bodies coming closer catch up at once. One that moved into a region with another phase
+        // may miss its step, it steps after twice the interval at the latest.
+        int interval = std::max(lodBands[band].interval, 1);
+        if (interval == 1 || closer || (step + lodPhase(position, interval)) % interval == 0 ||
+            physics.lodTime > (2 * interval - 0.5f) * deltaTime) {
+            steppedBodies.push_back(entity);
+        }
+    }
+    current.steppedBodies = steppedBodies.size();
+}
+
+// Narrowphase scratch, one set per thread. Candidate boxes are tested together by the SIMD kernels.
+struct NarrowphaseScratch {
+    std::vector<Entity> candidates;
+    AABBBatch candidateBoxes;
+    std::vector<uint8_t> endMasks, pathMasks;
+    std::vector<float> entryTimes;
+};
+
+static NarrowphaseScratch& getScratch() {
+    static thread_local NarrowphaseScratch scratch;
+    return scratch;
+}
+
+// Index of the box in scratch.candidateBoxes the ray origin + direction * t, t in [0, maxT], enters first,
+// SIZE_MAX if it misses them all. tEntry is 0 for a box the ray starts in.
+static size_t earliestEntry(NarrowphaseScratch& scratch, const Vec3& origin, const Vec3& direction, float maxT, float& tEntry) {
+    const AABBBatch& boxes = scratch.candidateBoxes;
+    tEntry = std::numeric_limits<float>::infinity();
+    if (!boxes.size()) return SIZE_MAX;
+
+    scratch.pathMasks.resize(boxes.maskSize());
+    scratch.entryTimes.resize(boxes.paddedSize());
+    rayBatch(boxes, origin, direction, maxT, scratch.entryTimes.data(), scratch.pathMasks.data());
+
+    size_t best = SIZE_MAX;
+    for (size_t group = 0; group < scratch.pathMasks.size(); group++) {
+        unsigned bits = scratch.pathMasks[group];
+        while (bits) {
+            size_t i = group * 8 + __builtin_ctz(bits);
+            bits &= bits - 1;
+            float t = std::max(scratch.entryTimes[i], 0.0f);
+            if (t < tEntry) {
+                tEntry = t;
+                best = i;
+            }
+        }
+    }
+    return best;
+}
+
+// Contact of a point moving by 'move' with a box: the face it is pushed out through if it is inside, the face
+// it enters through if it gets there during the move, or the face it rests on if it is within 'margin' of one.
+// Points near an edge or corner but not moving into the box get no contact, they would catch on it.
+// 'previous' is the normal the contact had last step, or null.
+static bool findContact(const Vec3& point, const Vec3& move, const AABB& box, float margin, const Vec3* previous,
+                        Vec3& normal, float& separation) {
+    const float p[3] = { point.x, point.y, point.z };
+    const float d[3] = { move.x, move.y, move.z };
+    const float boxMin[3] = { box.min.x, box.min.y, box.min.z };
+    const float boxMax[3] = { box.max.x, box.max.y, box.max.z };
+
+    // Gap to the box per axis, negative inside it. 'deepest' has the largest gap, i.e. the shallowest penetration.
+    // Bodies stacked straight up sit exactly on the side planes of the box below, so ties go to the vertical axis.
+    float gaps[3];
+    int outside = 0, deepest = 1;
+    for (int a : { 1, 0, 2 }) {
+        gaps[a] = std::max(boxMin[a] - p[a], p[a] - boxMax[a]);
+        if (gaps[a] > 0.0f) outside++;
+        if (gaps[a] > gaps[deepest]) deepest = a;
+    }
+
+    int axis = deepest;
+    float side = (boxMin[deepest] - p[deepest] > p[deepest] - boxMax[deepest]) ? -1.0f : 1.0f;
+    if (!outside && previous) {
+        // Sunk in a little, keep pushing out through the same face rather than flipping to a closer one
+        axis = previous->x != 0.0f ? 0 : (previous->y != 0.0f ? 1 : 2);
+        side = previous->x + previous->y + previous->z;
+        normal = *previous;
+        separation = side > 0.0f ? p[axis] - boxMax[axis] : boxMin[axis] - p[axis];
+        return true;
+    }
+    if (outside) {
+        float tEntry = 0.0f, tExit = 1.0f;
+        int entryAxis = -1;
+        for (int a = 0; a < 3 && tEntry <= tExit; a++) {
+            if (d[a] == 0.0f) {
+                if (gaps[a] > 0.0f) tEntry = std::numeric_limits<float>::infinity();
+                continue;
+            }
+            float t1 = (boxMin[a] - p[a]) / d[a];
+            float t2 = (boxMax[a] - p[a]) / d[a];
+            if (t1 > t2) std::swap(t1, t2);
+            if (t1 > tEntry) {
+                tEntry = t1;
+                entryAxis = a;
+            }
+            tExit = std::min(tExit, t2);
+        }
+
+        if (entryAxis >= 0 && tEntry <= tExit) {
+            axis = entryAxis;
+            side = d[entryAxis] > 0.0f ? -1.0f : 1.0f;
+        } else if (outside > 1 || gaps[deepest] > margin) {
+            return false;
+        }
+    }
+
+    float n[3] = { 0, 0, 0 };
+    n[axis] = side;
+    normal = Vec3(n[0], n[1], n[2]);
+    separation = gaps[axis];
+    return true;
+}
+
+void PhysicsSystem::findContacts(size_t body, float reach, std::vector<Contact>& result, PhysicsStats& work) {
+    NarrowphaseScratch& scratch = getScratch();
+    Entity entity = store.entities[body];
+    float deltaTime = store.deltaTime[body];
+    Vec3 position = store.getPosition(body);
+    Vec3 move = store.getVelocity(body) * deltaTime;
+    AABB region = expand(segmentBounds(position, position + move), contactMargin + reach);
+
+    std::vector<Entity>& candidates = scratch.candidates;
+    candidates.clear();
+    broadphase->query(region, candidates);
+    work.broadphaseCandidates += candidates.size();
+    size_t colliderCount = candidates.size();
+
+    // Cubes are found by visiting every cell of the region, fast bodies are left to the swept moves
+    scratch.candidateBoxes.clear();
+    for (Entity obj : candidates) {
+        scratch.candidateBoxes.add(getBounds(registry.getComponent<Transform>(obj).position));
+    }
+    if (length(move) <= maxStepDistance) {
+        gatherCubes(region, Vec3(0, 0, 0), scratch.candidateBoxes, candidates);
+    }
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        Entity obj = candidates[i];
+        AABB box = scratch.candidateBoxes.get(i);
+        if (obj == entity || !overlaps(box, region)) continue;
+        work.narrowphaseTests++;
+
+        // Awake bodies move too, test the motion relative to them
+        int32_t other = -1;
+        Vec3 relativeMove = move;
+        auto it = storeIndex.find(obj);
+        if (it != storeIndex.end()) {
+            other = (int32_t)it->second;
+            relativeMove = move - store.getVelocity(other) * deltaTime;
+        }
+
+        // Only a point inside the box needs last step's normal
+        Contact contact;
+        contact.key = ((uint64_t)entity << 32) | obj;
+        const Vec3* previous = nullptr;
+        if (contains(box, position)) {
+            auto manifold = manifolds.find(contact.key);
+            if (manifold != manifolds.end()) previous = &manifold->second.normal;
+        }
+        if (!findContact(position, relativeMove, box, contactMargin, previous, contact.normal, contact.separation)) {
+            continue;
+        }
+
+        // A face shared with a neighbouring cube is inside the ground, sliding over the seam must not catch on it
+        if (i >= colliderCount) {
+            Vec3 neighbour = box.min + contact.normal;
+            if (voxels.isSolid((int)neighbour.x, (int)neighbour.y, (int)neighbour.z)) continue;
+        }
+
+        contact.bodyA = (uint32_t)body;
+        contact.bodyB = other;
+        result.push_back(contact);
+    }
+
+    // Terrain under the body, against the plane of the triangle it is over
+    for (const Terrain& terrain : terrains) {
+        Vec3 local = position - terrain.offset;
+        float height;
+        Vec3 normal;
+        if (!terrain.field->getHeight(local.x, local.z, height, &normal)) continue;
+        work.narrowphaseTests++;
+
+        float separation = (local.y - height) * normal.y;
+        if (separation + std::min(dot(move, normal), 0.0f) > contactMargin) continue;
+
+        Contact contact;
+        contact.key = ((uint64_t)entity << 32) | terrain.entity;
+        contact.bodyA = (uint32_t)body;
+        contact.normal = normal;
+        contact.separation = separation;
+        result.push_back(contact);
+    }
+
+    // Meshes, against the closest point on them the body could reach this step
+    for (const StaticMesh& mesh : meshes) {
+        Vec3 local = position - mesh.offset;
+        if (!overlaps(expand(mesh.mesh->getBounds(), contactMargin + length(move)), AABB(local, local))) continue;
+        work.narrowphaseTests++;
+
+        MeshHit surfaceHit;
+        if (!mesh.mesh->closestPoint(local, contactMargin + length(move), surfaceHit)) continue;
+
+        // On the surface the face normal can face either way, take the side the body comes from
+        Vec3 normal = surfaceHit.normal;
+        if (surfaceHit.t <= 1e-6f && dot(move, normal) > 0.0f) normal = -normal;
+        if (surfaceHit.t + std::min(dot(move, normal), 0.0f) > contactMargin) continue;
+
+        Contact contact;
+        contact.key = ((uint64_t)entity << 32) | mesh.entity;
+        contact.bodyA = (uint32_t)body;
+        contact.normal = normal;
+        contact.separation = surfaceHit.t;
+        result.push_back(contact);
+    }
+}
+
+void PhysicsSystem::resolveContacts(PhysicsStats& current) {
+    ThreadPool& pool = ThreadPool::getInstance();
+    size_t count = store.size();
+
+    // Other bodies can close in on a body by up to the longest move, bounded so one fast body doesn't
+    // widen every search. Anything faster that gets through is pushed back out next step.
+    storeIndex.clear();
+    float longest = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        storeIndex[store.entities[i]] = (uint32_t)i;
+        longest = std::max(longest, length(store.getVelocity(i)) * store.deltaTime[i]);
+    }
+    float reach = std::min(longest, maxStepDistance);
+
+    // Per range lists joined in range order, the same for any number of threads
+    const size_t grain = 64;
+    rangeContacts.resize((count + grain - 1) / grain);
+    std::mutex workMutex;
+    pool.parallelFor(count, grain, [&](size_t begin, size_t end) {
+        PhysicsStats work;
+        std::vector<Contact>& found = rangeContacts[begin / grain];
+        found.clear();
+        for (size_t i = begin; i < end; i++) {
+            if (!(store.flags[i] & BodyStore::BODY_SIMPLIFIED)) findContacts(i, reach, found, work);
+        }
+
+        std::lock_guard<std::mutex> lock(workMutex);
+        current.addWork(work);
+    }, maxThreads);
+
+    // Bodies touching each other are solved together, islands of bodies don't share any
+    solverParents.resize(count);
+    for (uint32_t i = 0; i < count; i++) solverParents[i] = i;
+    auto find = [&](uint32_t i) {
+        while (solverParents[i] != i) {
+            solverParents[i] = solverParents[solverParents[i]]; // path halving
+            i = solverParents[i];
+        }
+        return i;
+    };
+
+    std::vector<Contact> found;
+    for (std::vector<Contact>& range : rangeContacts) {
+        for (Contact& contact : range) {
+            // Warm start from last step while the contact keeps its face
+            auto it = manifolds.find(contact.key);
+            if (it != manifolds.end() && dot(it->second.normal, contact.normal) > 0.5f) {
+                contact.normalImpulse = it->second.normalImpulse;
+                contact.tangentImpulse[0] = it->second.tangentImpulse[0];
+                contact.tangentImpulse[1] = it->second.tangentImpulse[1];
+            }
+            if (contact.bodyB >= 0) solverParents[find(contact.bodyA)] = find((uint32_t)contact.bodyB);
+            found.push_back(contact);
+        }
+    }
+
+    // Sort the contacts by island, islands numbered in order of their first contact
+    std::vector<int32_t> islandOfRoot(count, -1);
+    std::vector<uint32_t> islandOfContact(found.size());
+    solverIslandStarts.clear();
+    for (size_t i = 0; i < found.size(); i++) {
+        uint32_t root = find(found[i].bodyA);
+        if (islandOfRoot[root] == -1) {
+            islandOfRoot[root] = (int32_t)solverIslandStarts.size();
+            solverIslandStarts.push_back(0);
+        }
+        islandOfContact[i] = islandOfRoot[root];
+        solverIslandStarts[islandOfRoot[root]]++;
+    }
+    size_t islandCount = solverIslandStarts.size();
+    size_t offset = 0;
+    for (uint32_t& start : solverIslandStarts) {
+        size_t size = start;
+        start = (uint32_t)offset;
+        offset += size;
+    }
+    solverIslandStarts.push_back((uint32_t)offset);
+
+    solverContacts.resize(found.size());
+    std::vector<uint32_t> next(solverIslandStarts.begin(), solverIslandStarts.end() - 1);
+    for (size_t i = 0; i < found.size(); i++) solverContacts[next[islandOfContact[i]]++] = found[i];
+
+    // Islands only change their own bodies' velocities, so they are solved in parallel
+    std::vector<int> iterations(islandCount, 0);
+    pool.parallelFor(islandCount, 16, [&](size_t begin, size_t end) {
+        for (size_t island = begin; island < end; island++) {
+            Contact* contacts = solverContacts.data() + solverIslandStarts[island];
+            size_t size = solverIslandStarts[island + 1] - solverIslandStarts[island];
+            prepareContacts(store, contacts, size, contactSettings);
+            iterations[island] = ::solveContacts(store, contacts, size, contactSettings);
+        }
+    }, maxThreads);
+
+    // Keep the impulses for the next step, contacts that are gone are dropped
+    manifolds.clear();
+    for (const Contact& contact : solverContacts) {
+        manifolds[contact.key] = { contact.normal, contact.normalImpulse,
+                                   { contact.tangentImpulse[0], contact.tangentImpulse[1] } };
+    }
+
+    current.solverContacts = solverContacts.size();
+    current.solverIslands = islandCount;
+    for (int used : iterations) current.solverIterations = std::max(current.solverIterations, (uint32_t)used);
+}
+
+void PhysicsSystem::collideBody(size_t body, PhysicsStats& work) {
+    Entity entity = store.entities[body];
+    float deltaTime = store.deltaTime[body];
+    Vec3 start = registry.getComponent<Transform>(entity).position;
+    Vec3 end = store.getPosition(body);
+    Vec3 velocity = store.getVelocity(body);
+    Vec3 acceleration = store.getAcceleration(body);
+
+    // Collisions are found anywhere along a move, but a move ends at its first bounce. Fast bodies are
+    // redone as shorter moves so they keep the rest of the step after a bounce.
+    float distance = length(end - start);
+    if (distance > maxStepDistance) {
+        int substeps = std::min(maxSubsteps, (int)std::ceil(distance / maxStepDistance));
+        float substepTime = deltaTime / substeps;
+        work.substeppedBodies++;
+
+        end = start;
+        for (int i = 0; i < substeps; i++) {
+            Vec3 from = end;
+            end = from + velocity * substepTime;
+            moveBody(body, from, end, velocity, acceleration, work);
+        }
+    } else {
+        moveBody(body, start, end, velocity, acceleration, work);
+    }
+
+    store.setPosition(body, end);
+    store.setVelocity(body, velocity);
+    store.setAcceleration(body, acceleration);
+}
+
+void PhysicsSystem::moveBody(size_t body, const Vec3& from, Vec3& to, Vec3& velocity, Vec3& acceleration,
+                             PhysicsStats& work) {
+    NarrowphaseScratch& scratch = getScratch();
+    Entity entity = store.entities[body];
+    Vec3 p = from;
+    Vec3 pNext = to;
+
+    // Static cubes are found by walking the grid cells along the path
+    bool collision = false;
+    float tHit = std::numeric_limits<float>::infinity();
+    Vec3 hitNormal;
+    VoxelHit voxelHit;
+    if (voxels.raycast(p, pNext - p, 1.0f, voxelHit, true)) {
+        tHit = voxelHit.t;
+        hitNormal = voxelHit.normal;
+        collision = true;
+    }
+
+    // A body already below a terrain surface is only stopped while it moves further in
+    for (const Terrain& terrain : terrains) {
+        HeightfieldHit surfaceHit;
+        if (terrain.field->raycast(p - terrain.offset, pNext - p, 1.0f, surfaceHit) && surfaceHit.t < tHit &&
+            (surfaceHit.t > 0.0f || dot(pNext - p, surfaceHit.normal) < 0.0f)) {
+            tHit = surfaceHit.t;
+            hitNormal = surfaceHit.normal;
+            collision = true;
+        }
+    }
+    for (const StaticMesh& mesh : meshes) {
+        MeshHit surfaceHit;
+        if (mesh.mesh->raycast(p - mesh.offset, pNext - p, 1.0f, surfaceHit) && surfaceHit.t < tHit) {
+            tHit = surfaceHit.t;
+            hitNormal = surfaceHit.normal;
+            collision = true;
+        }
+    }
+
+    // Only broadphase colliders whose bounds overlap the path can be hit
+    std::vector<Entity>& candidates = scratch.candidates;
+    candidates.clear();
+    broadphase->query(segmentBounds(p, pNext), candidates);
+    work.moves++;
+    work.broadphaseCandidates += candidates.size();
+
+    // Narrowphase in batches, every box the path enters is a hit
+    AABBBatch& candidateBoxes = scratch.candidateBoxes;
+    candidateBoxes.clear();
+    size_t count = 0;
+    bool simplified = store.flags[body] & BodyStore::BODY_SIMPLIFIED;
+    for (Entity obj : candidates) {
+        if (obj == entity || (!simplified && storeIndex.count(obj))) continue;
+        candidates[count++] = obj;
+        candidateBoxes.add(getBounds(registry.getComponent<Transform>(obj).position));
+    }
+    candidates.resize(count);
+    work.narrowphaseTests += count;
 
-        if (physics.isStatic) continue;
-
-        Vec3 p = transform.position;
-        Vec3 pNext = p + (physics.velocity * deltaTime); 
-        
-        bool collision = false;
-        std::vector<Entity> objects = registry.getEntitiesWith(TRANSFORM_MASK);
-        for (auto obj : objects) {
-            if (obj == entity) continue;
-            
-            Vec3 otherP = registry.getComponent<Transform>(obj).position;
-
-            Vec3 AABBmin = otherP;
-            Vec3 AABBmax = otherP + Vec3(1,1,1);    
-            // Check if collision is going to happen
-            if (PointInAABB(pNext, AABBmin, AABBmax)) {
-                // Calculate collision point and direction
-                float tEntry, tExit;
-                Vec3 collisionNormal;
-                
-                if (rayDetectionAABB(p, (pNext - p), AABBmin, AABBmax, collisionNormal, tEntry, tExit)) {
-                    // Get rebound vector and collision point
-                    Vec3 collisionPoint = p + (pNext - p) * tEntry;                    
-
-                    transform.position = collisionPoint + collisionNormal * epsilon;
-                    physics.velocity = calculateRebound(physics.velocity, collisionNormal, 0.8f);
-                    if (length(physics.velocity) < 0.2f) physics.isStatic = true;
-                    collision = true;
-                    break;
+    size_t best = SIZE_MAX;
+    if (count) {
+        scratch.endMasks.resize(candidateBoxes.maskSize());
+        scratch.pathMasks.resize(candidateBoxes.maskSize());
+        scratch.entryTimes.resize(candidateBoxes.paddedSize());
+        containsPointBatch(candidateBoxes, pNext, scratch.endMasks.data());
+        rayBatch(candidateBoxes, p, pNext - p, 1.0f, scratch.entryTimes.data(), scratch.pathMasks.data());
+
+        // Take the earliest time of impact along the path. A body that starts inside a box
+        // is only pushed back out if it would still be inside at the end.
+        for (size_t group = 0; group < scratch.pathMasks.size(); group++) {
+            unsigned bits = scratch.pathMasks[group];
+            while (bits) {
+                size_t i = group * 8 + __builtin_ctz(bits);
+                bits &= bits - 1;
+                if (scratch.entryTimes[i] < 0.0f && !(scratch.endMasks[group] & (1u << (i % 8)))) continue;
+                if (scratch.entryTimes[i] < tHit) {
+                    tHit = scratch.entryTimes[i];
+                    best = i;
                 }
-            } 
+            }
+        }
+
+        if (best != SIZE_MAX) {
+            // Only the winner needs its normal
+            AABB box = candidateBoxes.get(best);
+            float tEntry, tExit;
+            rayDetectionAABB(p, (pNext - p), box.min, box.max, hitNormal, tEntry, tExit);
+            collision = true;
         }
-        if (!collision) {
-            transform.position = pNext;
-            physics.velocity = physics.velocity + (physics.acceleration * deltaTime);
-            physics.acceleration.y = gravity;
-        } 
     }
 
-    entities.clear();
+    if (collision) {
+        // Get rebound vector and collision point
+        Vec3 collisionPoint = p + (pNext - p) * tHit;
+
+        to = collisionPoint + hitNormal * epsilon;
+        velocity = calculateRebound(velocity, hitNormal, 0.8f);
+        work.collisions++;
+
+        if (best != SIZE_MAX) {
+            store.contacts[body] = candidates[best];
+            store.flags[body] |= BodyStore::BODY_TOUCHED;
+        }
+    } else {
+        acceleration.y = gravity;
+    } 
 }
 
-bool PhysicsSystem::overlapDetectionAABB(const Vec3& min1, const Vec3& max1, const Vec3& min2, const Vec3& max2) {
-    return (min1.x <= max2.x && max1.x >= min2.x) && // Overlap on X
-        (min1.y <= max2.y && max1.y >= min2.y) && // Overlap on Y
-        (min1.z <= max2.z && max1.z >= min2.z);   // Overlap on Z
+void PhysicsSystem::update(float deltaTime) {
+    // Phase timings for getStats, always on, a clock read per phase costs next to nothing
+    uint64_t stepStart = Profiler::now();
+    uint64_t phaseStart = stepStart;
+    auto lap = [&]() {
+        uint64_t now = Profiler::now();
+        double ms = (now - phaseStart) / 1e6;
+        phaseStart = now;
+        return ms;
+    };
+    PhysicsStats current;
+    current.step = stepCount++;
+
+    syncBroadphase();
+
+    // Bodies woken between steps join this one
+    awakeBodies.insert(awakeBodies.end(), woken.begin(), woken.end());
+    woken.clear();
+    selectSteppedBodies(deltaTime, current.step, current);
+
+    ThreadPool& pool = ThreadPool::getInstance();
+    size_t count = steppedBodies.size();
+    store.resize(count);
+    current.syncMs = lap();
+
+    {
+        PROFILE_ZONE("PhysicsSystem::integrate");
+        // Ranges are whole SIMD groups so integrating one can't touch another thread's bodies
+        pool.parallelFor(count, 1024, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                Entity entity = steppedBodies[i];
+                Physics& physics = registry.getComponent<Physics>(entity);
+                store.entities[i] = entity;
+                store.setPosition(i, registry.getComponent<Transform>(entity).position);
+                store.setVelocity(i, physics.velocity);
+                store.setAcceleration(i, physics.acceleration);
+                store.inverseMass[i] = physics.mass > 0.0f ? 1.0f / physics.mass : 1.0f; // as in applyImpulse
+                store.deltaTime[i] = physics.lodTime;
+                store.flags[i] = (lodCamera && lodBands[physics.lodBand].simplified) ? BodyStore::BODY_SIMPLIFIED : 0;
+                physics.lodTime = 0.0f;
+            }
+            integrateVelocities(store, begin, end);
+        }, maxThreads);
+    }
+    current.integrateMs = lap();
+
+    {
+        PROFILE_ZONE("PhysicsSystem::solve");
+        resolveContacts(current);
+    }
+    current.solveMs = lap();
+
+    // Bodies only read the world here, each one writes its own entry in the store
+    {
+        PROFILE_ZONE("PhysicsSystem::collide");
+        // Counted per range and merged once, so the totals are the same for any number of threads
+        std::mutex workMutex;
+        pool.parallelFor(count, 64, [&](size_t begin, size_t end) {
+            PhysicsStats work;
+            integratePositions(store, begin, end);
+            for (size_t i = begin; i < end; i++) collideBody(i, work);
+
+            std::lock_guard<std::mutex> lock(workMutex);
+            current.addWork(work);
+        }, maxThreads);
+    }
+    current.collideMs = lap();
+
+    // Each body writes back only its own components
+    {
+        PROFILE_ZONE("PhysicsSystem::writeBack");
+        pool.parallelFor(count, 256, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                Transform& transform = registry.getComponent<Transform>(store.entities[i]);
+                Physics& physics = registry.getComponent<Physics>(store.entities[i]);
+                transform.position = store.getPosition(i);
+                physics.velocity = store.getVelocity(i);
+                physics.acceleration = store.getAcceleration(i);
+
+                // A body rests while it stays near one spot. Its speed is no use here, a body settled on the
+                // ground keeps bouncing by tiny amounts as every step adds gravity before the ground pushes back.
+                if (length(transform.position - physics.restPosition) < sleepDistance) {
+                    physics.sleepTimer += store.deltaTime[i];
+                } else {
+                    physics.restPosition = transform.position;
+                    physics.sleepTimer = 0.0f;
+                }
+            }
+        }, maxThreads);
+
+        // Let the renderer know which transforms to upload again, the store's padding lanes hold no bodies
+        for (size_t i = 0; i < count; i++) registry.markChanged(store.entities[i]);
+    }
+    current.writeBackMs = lap();
+
+    // Shared state is updated on this thread in body order
+    {
+        PROFILE_ZONE("PhysicsSystem::contacts");
+        // Bodies pushing on each other share an island, a sleeping body being pushed wakes up. Bodies
+        // skipping this step are in the contacts like static ones, but they still share the island.
+        for (const Contact& contact : solverContacts) {
+            if (contact.normalImpulse <= 0.0f) continue;
+            Entity entity = store.entities[contact.bodyA];
+            Entity other = (Entity)(contact.key & 0xFFFFFFFF);
+            if (contact.bodyB >= 0 || (registry.match(other, PHYSICS_MASK) && !registry.getComponent<Physics>(other).isStatic)) {
+                wake(other);
+                contacts[contactKey(entity, other)] = 0.0f;
+                current.bodyContacts++;
+            }
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            Entity entity = store.entities[i];
+
+            // Touching another body links the two into one island and wakes it if it sleeps
+            Entity other = store.contacts[i];
+            if ((store.flags[i] & BodyStore::BODY_TOUCHED) && registry.match(other, PHYSICS_MASK) &&
+                !registry.getComponent<Physics>(other).isStatic) {
+                wake(other);
+                contacts[contactKey(entity, other)] = 0.0f;
+                current.bodyContacts++;
+            }
+
+            broadphase->update(entity, getBounds(store.getPosition(i)));
+        }
+    }
+    current.contactsMs = lap();
+
+    updateIslands(deltaTime);
+    current.islandsMs = lap();
+    current.totalMs = (phaseStart - stepStart) / 1e6;
+
+    current.awakeBodies = awakeBodies.size();
+    current.sleepingBodies = islandOf.size();
+    current.colliders = colliderCount;
+    current.staticCubes = cubeCount;
+    stats = current;
+
+    if (!statsLog.empty()) {
+        statsLog[statsLogHead] = stats;
+        statsLogHead = (statsLogHead + 1) % statsLog.size();
+        statsLogged = std::min(statsLogged + 1, statsLog.size());
+    }
 }
 
-bool PhysicsSystem::PointInAABB(const Vec3& point, const Vec3& AABBmin, const Vec3& AABBmax) {
-    return (point.x >= AABBmin.x && point.x <= AABBmax.x) &&
-           (point.y >= AABBmin.y && point.y <= AABBmax.y) &&
-           (point.z >= AABBmin.z && point.z <= AABBmax.z);
+void PhysicsSystem::setStatsLogSize(size_t steps) {
+    statsLog.assign(steps, PhysicsStats());
+    statsLogHead = 0;
+    statsLogged = 0;
 }
 
+std::vector<PhysicsStats> PhysicsSystem::getStatsLog() {
+    // The head is the next slot to write, which holds the oldest step once the ring is full
+    std::vector<PhysicsStats> steps;
+    size_t oldest = (statsLogged < statsLog.size()) ? 0 : statsLogHead;
+    for (size_t i = 0; i < statsLogged; i++) {
+        steps.push_back(statsLog[(oldest + i) % statsLog.size()]);
+    }
+    return steps;
+}
+
+bool PhysicsSystem::exportStatsLog(const char* filepath) {
+    std::ofstream file(filepath);
+    if (!file) {
+        std::cerr << "Failed to open physics stats log " << filepath << std::endl;
+        return false;
+    }
+    writeStatsCSV(file, getStatsLog());
+    return true;
+}
+
+bool PhysicsSystem::raycast(const Vec3& origin, const Vec3& direction, float maxDistance, QueryHit& hit, uint32_t layerMask) {
+    if (registryVersion != registry.getVersion()) syncBroadphase();
+    castRay({ origin, direction, maxDistance, layerMask }, hit);
+    return hit.hit;
+}
+
+void PhysicsSystem::raycast(const RayQuery* queries, size_t count, QueryHit* hits) {
+    if (registryVersion != registry.getVersion()) syncBroadphase();
+    ThreadPool::getInstance().parallelFor(count, 32, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) castRay(queries[i], hits[i]);
+    }, maxThreads);
+}
+
+bool PhysicsSystem::sweep(const AABB& box, const Vec3& direction, float maxDistance, QueryHit& hit, uint32_t layerMask) {
+    if (registryVersion != registry.getVersion()) syncBroadphase();
+    castBox({ box, direction, maxDistance, layerMask }, hit);
+    return hit.hit;
+}
+
+void PhysicsSystem::sweep(const SweepQuery* queries, size_t count, QueryHit* hits) {
+    if (registryVersion != registry.getVersion()) syncBroadphase();
+    ThreadPool::getInstance().parallelFor(count, 32, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) castBox(queries[i], hits[i]);
+    }, maxThreads);
+}
+
+void PhysicsSystem::overlapBox(const AABB& box, std::vector<Entity>& result, uint32_t layerMask) {
+    if (registryVersion != registry.getVersion()) syncBroadphase();
+    findOverlaps(box, Vec3(0, 0, 0), -1.0f, layerMask, result);
+}
+
+void PhysicsSystem::overlapBox(const BoxQuery* queries, size_t count, std::vector<std::vector<Entity>>& results) {
+    if (registryVersion != registry.getVersion()) syncBroadphase();
+    results.resize(count);
+    ThreadPool::getInstance().parallelFor(count, 32, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            results[i].clear();
+            findOverlaps(queries[i].box, Vec3(0, 0, 0), -1.0f, queries[i].layerMask, results[i]);
+        }
+    }, maxThreads);
+}
+
+void PhysicsSystem::overlapSphere(const Vec3& center, float radius, std::vector<Entity>& result, uint32_t layerMask) {
+    if (registryVersion != registry.getVersion()) syncBroadphase();
+    if (!(radius >= 0.0f)) return;
+    Vec3 extent(radius, radius, radius);
+    findOverlaps({ center - extent, center + extent }, center, radius, layerMask, result);
+}
+
+void PhysicsSystem::overlapSphere(const SphereQuery* queries, size_t count, std::vector<std::vector<Entity>>& results) {
+    if (registryVersion != registry.getVersion()) syncBroadphase();
+    results.resize(count);
+    ThreadPool::getInstance().parallelFor(count, 32, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            results[i].clear();
+            const SphereQuery& query = queries[i];
+            if (!(query.radius >= 0.0f)) continue;
+            Vec3 extent(query.radius, query.radius, query.radius);
+            findOverlaps({ query.center - extent, query.center + extent }, query.center, query.radius,
+                         query.layerMask, results[i]);
+        }
+    }, maxThreads);
+}
+
+void PhysicsSystem::castRay(const RayQuery& query, QueryHit& hit) {
+    hit = QueryHit();
+    float len = length(query.direction);
+    if (len <= 0.0f || !(query.maxDistance >= 0.0f)) return;
+    Vec3 direction = query.direction / len;
+
+    // Static cubes are all on the default layer
+    VoxelHit voxelHit;
+    if ((query.layerMask & COLLISION_LAYER_DEFAULT) &&
+        voxels.raycast(query.origin, direction, query.maxDistance, voxelHit)) {
+        hit.hit = true;
+        hit.entity = voxelHit.entity;
+        hit.distance = voxelHit.t;
+        hit.normal = voxelHit.normal;
+    }
+
+    for (const Terrain& terrain : terrains) {
+        HeightfieldHit surfaceHit;
+        if ((query.layerMask & terrain.layers) &&
+            terrain.field->raycast(query.origin - terrain.offset, direction, query.maxDistance, surfaceHit) &&
+            (!hit.hit || surfaceHit.t < hit.distance)) {
+            hit.hit = true;
+            hit.entity = terrain.entity;
+            hit.distance = surfaceHit.t;
+            hit.normal = surfaceHit.normal;
+        }
+    }
+    for (const StaticMesh& mesh : meshes) {
+        MeshHit surfaceHit;
+        if ((query.layerMask & mesh.layers) &&
+            mesh.mesh->raycast(query.origin - mesh.offset, direction, query.maxDistance, surfaceHit) &&
+            (!hit.hit || surfaceHit.t < hit.distance)) {
+            hit.hit = true;
+            hit.entity = mesh.entity;
+            hit.distance = surfaceHit.t;
+            hit.normal = surfaceHit.normal;
+        }
+    }
+
+    NarrowphaseScratch& scratch = getScratch();
+    scratch.candidates.clear();
+    broadphase->raycast(query.origin, direction, query.maxDistance, scratch.candidates, query.layerMask);
+    scratch.candidateBoxes.clear();
+    for (Entity obj : scratch.candidates) {
+        scratch.candidateBoxes.add(getBounds(registry.getComponent<Transform>(obj).position));
+    }
+
+    float tHit;
+    size_t best = earliestEntry(scratch, query.origin, direction, query.maxDistance, tHit);
+    if (best != SIZE_MAX && (!hit.hit || tHit < hit.distance)) {
+        AABB box = scratch.candidateBoxes.get(best);
+        float tEntry, tExit;
+        rayDetectionAABB(query.origin, direction, box.min, box.max, hit.normal, tEntry, tExit);
+        hit.hit = true;
+        hit.entity = scratch.candidates[best];
+        hit.distance = tHit;
+    }
+    hit.point = query.origin + direction * hit.distance;
+}
+
+void PhysicsSystem::castBox(const SweepQuery& query, QueryHit& hit) {
+    hit = QueryHit();
+    float len = length(query.direction);
+    if (len <= 0.0f || !(query.maxDistance >= 0.0f)) return;
+    Vec3 direction = query.direction / len;
+
+    // Growing every collider by the size of the box turns the sweep into a ray from the box's min corner
+    Vec3 size = query.box.max - query.box.min;
+    Vec3 travel = direction * query.maxDistance;
+    AABB swept = merge(query.box, { query.box.min + travel, query.box.max + travel });
+
+    NarrowphaseScratch& scratch = getScratch();
+    scratch.candidates.clear();
+    broadphase->query(swept, scratch.candidates, query.layerMask);
+    scratch.candidateBoxes.clear();
+    for (Entity obj : scratch.candidates) {
+        AABB box = getBounds(registry.getComponent<Transform>(obj).position);
+        scratch.candidateBoxes.add({ box.min - size, box.max });
+    }
+    if (query.layerMask & COLLISION_LAYER_DEFAULT) {
+        gatherCubes(swept, size, scratch.candidateBoxes, scratch.candidates);
+    }
+
+    float tHit;
+    size_t best = earliestEntry(scratch, query.box.min, direction, query.maxDistance, tHit);
+    if (best != SIZE_MAX) {
+        AABB box = scratch.candidateBoxes.get(best);
+        float tEntry, tExit;
+        rayDetectionAABB(query.box.min, direction, box.min, box.max, hit.normal, tEntry, tExit);
+        hit.hit = true;
+        hit.entity = scratch.candidates[best];
+        hit.distance = tHit;
+    }
+
+    for (const Terrain& terrain : terrains) {
+        HeightfieldHit surfaceHit;
+        AABB local = { query.box.min - terrain.offset, query.box.max - terrain.offset };
+        if ((query.layerMask & terrain.layers) && terrain.field->sweep(local, direction, query.maxDistance, surfaceHit) &&
+            (!hit.hit || surfaceHit.t < hit.distance)) {
+            hit.hit = true;
+            hit.entity = terrain.entity;
+            hit.distance = surfaceHit.t;
+            hit.normal = surfaceHit.normal;
+        }
+    }
+    for (const StaticMesh& mesh : meshes) {
+        MeshHit surfaceHit;
+        AABB local = { query.box.min - mesh.offset, query.box.max - mesh.offset };
+        if ((query.layerMask & mesh.layers) && mesh.mesh->sweep(local, direction, query.maxDistance, surfaceHit) &&
+            (!hit.hit || surfaceHit.t < hit.distance)) {
+            hit.hit = true;
+            hit.entity = mesh.entity;
+            hit.distance = surfaceHit.t;
+            hit.normal = surfaceHit.normal;
+        }
+    }
+    hit.point = query.box.min + direction * hit.distance;
+}
+
+void PhysicsSystem::findOverlaps(const AABB& bounds, const Vec3& center, float radius, uint32_t layerMask,
+                                 std::vector<Entity>& result) {
+    for (const Terrain& terrain : terrains) {
+        if (!(layerMask & terrain.layers)) continue;
+        bool touching = radius >= 0.0f ? terrain.field->overlaps(center - terrain.offset, radius)
+                                       : terrain.field->overlaps(AABB(bounds.min - terrain.offset, bounds.max - terrain.offset));
+        if (touching) result.push_back(terrain.entity);
+    }
+    for (const StaticMesh& mesh : meshes) {
+        if (!(layerMask & mesh.layers)) continue;
+        bool touching = radius >= 0.0f ? mesh.mesh->overlaps(center - mesh.offset, radius)
+                                       : mesh.mesh->overlaps(AABB(bounds.min - mesh.offset, bounds.max - mesh.offset));
+        if (touching) result.push_back(mesh.entity);
+    }
+
+    NarrowphaseScratch& scratch = getScratch();
+    scratch.candidates.clear();
+    broadphase->query(bounds, scratch.candidates, layerMask);
+    scratch.candidateBoxes.clear();
+    for (Entity obj : scratch.candidates) {
+        scratch.candidateBoxes.add(getBounds(registry.getComponent<Transform>(obj).position));
+    }
+    if (layerMask & COLLISION_LAYER_DEFAULT) {
+        gatherCubes(bounds, Vec3(0, 0, 0), scratch.candidateBoxes, scratch.candidates);
+    }
+    if (!scratch.candidateBoxes.size()) return;
+
+    // The tree's fat bounds and the cube gathering are loose, test the real boxes
+    scratch.endMasks.resize(scratch.candidateBoxes.maskSize());
+    overlapBatch(scratch.candidateBoxes, bounds, scratch.endMasks.data());
+    for (size_t group = 0; group < scratch.endMasks.size(); group++) {
+        unsigned bits = scratch.endMasks[group];
+        while (bits) {
+            size_t i = group * 8 + __builtin_ctz(bits);
+            bits &= bits - 1;
+            if (radius >= 0.0f) {
+                AABB box = scratch.candidateBoxes.get(i);
+                Vec3 closest = maxVec(box.min, minVec(center, box.max));
+                if (dot(closest - center, closest - center) > radius * radius) continue;
+            }
+            result.push_back(scratch.candidates[i]);
+        }
+    }
+}
+
+void PhysicsSystem::gatherCubes(const AABB& bounds, const Vec3& grow, AABBBatch& boxes, std::vector<Entity>& owners) {
+    // Cube (x, y, z) covers [x, x + 1], so the ones touching the bounds start at ceil(min - 1).
+    // This visits every cell in the bounds, keep the queried volume small.
+    int minX = (int)std::ceil(bounds.min.x - 1.0f), maxX = (int)std::floor(bounds.max.x);
+    int minY = (int)std::ceil(bounds.min.y - 1.0f), maxY = (int)std::floor(bounds.max.y);
+    int minZ = (int)std::ceil(bounds.min.z - 1.0f), maxZ = (int)std::floor(bounds.max.z);
+    for (int x = minX; x <= maxX; x++) {
+        for (int y = minY; y <= maxY; y++) {
+            for (int z = minZ; z <= maxZ; z++) {
+                if (!voxels.isSolid(x, y, z)) continue;
+                Vec3 cube(x, y, z);
+                boxes.add({ cube - grow, cube + Vec3(1, 1, 1) });
+                owners.push_back(voxels.getEntity(x, y, z));
+            }
+        }
+    }
+}
 
 bool PhysicsSystem::rayDetectionAABB(const Vec3& point, const Vec3& direction, const Vec3& AABBmin, const Vec3& AABBmax, 
                                             Vec3& collisionNormal, float& tEntry, float& tExit) {
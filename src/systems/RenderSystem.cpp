@@ -1,43 +1,123 @@
 #include "systems/RenderSystem.h"
 #include <algorithm>
 #include "glad/glad.h"
+#include "core/Profiler.h"
 
 const float globalAmbience = 0.1f;
 
+RenderSystem::RenderSystem(SDL_Window* window, std::shared_ptr<Camera> camera, SDL_GLContext pipelineContext)
+    : window(window), camera(camera) {
+    if (pipelineContext) {
+        renderThread = std::make_unique<RenderThread>(window, pipelineContext);
+        renderThread->start([this](const FramePacket& packet) { submitPacket(packet); });
+    }
+}
+
+RenderSystem::~RenderSystem() {
+    // Join the render thread before the packets and resources it uses go away
+    if (renderThread) renderThread->stop();
+}
+
 void RenderSystem::processEvent(const Event& event, float deltaTime) {
     
 }
 
 void RenderSystem::update(float deltaTime) {
+    if (renderThread) {
+        // Simulate ahead while the render thread draws the previous frame
+        FramePipeline& pipeline = renderThread->getPipeline();
+        FramePacket* next = pipeline.beginWrite();
+        if (!next) return;
+        preparePacket(*next);
+        pipeline.endWrite();
+    } else {
+        preparePacket(packet);
+        submitPacket(packet);
+        packet.released.clear();
+    }
+}
+
+void RenderSystem::preparePacket(FramePacket& packet) {
+    PROFILE_ZONE("RenderSystem::preparePacket");
+    packet.clear();
+    packet.matCamera = camera->getMatCamera();
+    packet.eyePos = camera->position;
+    getLightSources(8, packet.lights); // the 8 closest light sources are bound to the shader
+
+    // Only slots of entities that were added, removed or changed get new data
+    scene.update();
+    packet.runs = scene.getRuns();
+    packet.instanceCount = scene.getInstanceCount();
+
+    // The render thread may still be reading the GPU buffer, stage the new data in the packet for it.
+    // Otherwise it goes straight into this frame's part of the mapped upload buffer.
+    InstanceData* instances;
+    if (renderThread) {
+        if (packet.instances.size() < packet.instanceCount) packet.instances.resize(packet.instanceCount);
+        instances = packet.instances.data();
+    } else {
+        instances = instanceRing.beginFrame(packet.instanceCount);
+    }
+    if (instances) {
+        scene.writeInstances(instances);
+    } else {
+        packet.runs.clear();
+    }
+    scene.takeTextureUploads(packet.textureUploads);
+    scene.takeReleased(packet.released);
+
+    // Every batch is drawn from its slots, the ones not in use are skipped
+    const std::vector<RenderScene::Batch>& batches = scene.getBatches();
+    if (packet.batches.size() < batches.size()) packet.batches.resize(batches.size());
+    packet.batchCount = batches.size();
+    for (size_t i = 0; i < batches.size(); i++) {
+        packet.batches[i].shape = batches[i].shape;
+        packet.batches[i].textureArrays = batches[i].textureArrays;
+        packet.batches[i].instanceCount = (uint32_t)batches[i].slots.size();
+    }
+}
+
+void RenderSystem::submitPacket(const FramePacket& packet) {
+    PROFILE_ZONE("RenderSystem::submitPacket");
     // Clear the screen
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glDepthRange(0.1f, 10.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    entities = registry.getEntitiesWith(requiredComponents);
-    renderEntities();
-
-    // Swap buffers
-    SDL_GL_SwapWindow(window);
-
-    // Clear entity container for the next frame (will probably need optimisation in the future)
-    entities.clear();
-}
+    // Copy staged instances in one go, single threaded mode already wrote them to the upload buffer
+    bool uploaded = true;
+    if (renderThread) {
+        PROFILE_ZONE("InstanceRing copy");
+        InstanceData* instances = instanceRing.beginFrame(packet.instanceCount);
+        uploaded = instances != nullptr;
+        if (uploaded) std::copy_n(packet.instances.data(), packet.instanceCount, instances);
+    }
 
-void RenderSystem::renderEntities() {
-    // Map entities to shapes
-    std::unordered_map<std::shared_ptr<Shape>, std::vector<Entity>> shapeMap;
-    for (auto& entity : entities) {
-        auto& material = registry.getComponent<Material>(entity);
-        shapeMap[material.shape].push_back(entity);
+    // Patch the changed slots, copies on the GPU that run before this frame's draws
+    if (instanceBuffers.size() < packet.batchCount) instanceBuffers.resize(packet.batchCount);
+    for (size_t i = 0; i < packet.batchCount; i++) {
+        instanceBuffers[i].reserve(packet.batches[i].instanceCount);
     }
-    for (auto& [shape, entities] : shapeMap) {
-        renderInstancesArray(entities);
+    for (size_t i = 0; i < packet.runs.size() && uploaded; i++) {
+        const InstanceRun& run = packet.runs[i];
+        instanceBuffers[run.batch].copy(instanceRing.getBuffer(), instanceRing.getBaseInstance() + run.first, run.slot,
+                                        run.count);
     }
+    instanceRing.endFrame();
+    textureArrays.upload(packet.textureUploads);
+
+    for (size_t i = 0; i < packet.batchCount; i++) {
+        if (packet.batches[i].shape && packet.batches[i].instanceCount) {
+            renderInstancesArray(packet.batches[i], instanceBuffers[i], packet);
+        }
+    }
+
+    // Swap buffers
+    SDL_GL_SwapWindow(window);
 }
 
 
-std::vector<LightData> RenderSystem::getLightSources(size_t amount) {
+void RenderSystem::getLightSources(size_t amount, std::vector<LightData>& lights) {
     // get all lights and sort them by distance to camera.
     auto entities = registry.getEntitiesWith(LIGHT_SOURCE_MASK | TRANSFORM_MASK);
     auto compare = [&](Entity a, Entity b) -> bool {
@@ -59,7 +139,6 @@ std::vector<LightData> RenderSystem::getLightSources(size_t amount) {
     }
 
     // return the 'amount' first aka closest lights to the camera
-    std::vector<LightData> lights;
     amount = std::min(amount, entities.size());
     for (size_t i = 0; i < amount; i++) {
         LightSource light = registry.getComponent<LightSource>(entities[i]);
@@ -67,66 +146,44 @@ std::vector<LightData> RenderSystem::getLightSources(size_t amount) {
         LightData data = {position, light.color, light.intensity, light.constant, light.linear, light.quadratic};
         lights.push_back(data);
     }
-    return lights;
 }
 
 
-void RenderSystem::renderInstancesArray(std::vector<Entity> entities) {    
-    // Generate instance data and texture array
-    std::vector<InstanceData> instances;
-    TextureArray textures;
-    for (auto& entity : entities) {
-        auto& material = registry.getComponent<Material>(entity);
-        auto& transform = registry.getComponent<Transform>(entity);
-        
-        InstanceData newInstance;
-        newInstance.matWorld = MatrixWorld(transform.position, transform.rotation, transform.scale);
-        newInstance.reflectivity = material.reflectivity;
-        newInstance.shininess = material.shininess;
-
-        bool newTexture = true;
-        for (int i = 0; i < textures.array.size(); i++) {
-            if (material.texture == textures.array[i]) {
-                newInstance.textureIndex = i;
-                newTexture = false;
-            }
-        }
-
-        if (newTexture) {
-            newInstance.textureIndex = textures.array.size();
-            textures.array.push_back(material.texture);
-        }
-        instances.push_back(newInstance);
-    }
-
-    auto& shape = registry.getComponent<Material>(entities[0]).shape;
+void RenderSystem::renderInstancesArray(const DrawBatch& batch, const InstanceBuffer& instances,
+                                        const FramePacket& packet) {    
+    PROFILE_ZONE("RenderSystem::renderInstancesArray");
 
     // Use the appropiate shader
     auto shader = resourceManager.getShader("lib/shaders/arrayVisual.glsl");
     shader->use();
 
     // Bind the VAO
-    shape->bindVAO(); 
-
-    // Load texture array to GPU
-    textures.loadTexturesToGPU();
+    batch.shape->bindVAO(); 
+
+    // Bind camera matrix and lights
+    {
+        PROFILE_ZONE("Shader binding");
+        shader->bindMatrix(packet.matCamera, "matCamera");
+        shader->bindFloat(globalAmbience, "globalAmbience");
+        shader->bindVector(packet.eyePos, "eyePos");
+        shader->bindLights(packet.lights);
+
+        Vec3 sunDir = Vec3(0.6, -0.6, 0.6);
+        Vec3 sunCol = Vec3(1.0, 0.9, 0.9);
+        shader->bindVector(sunDir, "directionalLightDir");
+        shader->bindVector(sunCol, "directionalLightColor");
+    }
 
-    // Bind textures and camera matrix
-    shader->bindTextureArray(textures.textureArrayID);
-    shader->bindMatrix(camera->getMatCamera(), "matCamera");
-    shader->bindFloat(globalAmbience, "globalAmbience");
-    shader->bindVector(camera->position, "eyePos");
-    shader->bindLights(getLightSources(8)); // bind 8 closest light sources to shader
-    
-    Vec3 sunDir = Vec3(0.6, -0.6, 0.6);
-    Vec3 sunCol = Vec3(1.0, 0.9, 0.9);
-    shader->bindVector(sunDir, "directionalLightDir");
-    shader->bindVector(sunCol, "directionalLightColor");
+    // Draw instances, usually all textures of a shape share one array
+    for (uint16_t array : batch.textureArrays) {
+        shader->bindTextureArray(textureArrays.getArray(array));
+        shader->bindUInt(array, "textureArrayIndex");
 
-    // Draw instances
-    shape->drawInstancesArray(instances); 
+        PROFILE_ZONE("Shape::drawInstancesArray");
+        batch.shape->drawInstancesArray(instances.getBuffer(), 0, batch.instanceCount);
+    }
 }
 
-void RenderSystem::renderInstancesAtlas(std::vector<Entity> entities) {
+void RenderSystem::renderInstancesAtlas(const DrawBatch& batch, const FramePacket& packet) {
     
-}
\ No newline at end of file
+}
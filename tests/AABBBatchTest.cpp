@@ -0,0 +1,78 @@
+#include "SimpleTestFramework.h"
+#include "physics/AABBBatch.h"
+#include <random>
+
+static AABBBatch randomBatch(std::mt19937& rng, size_t count) {
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> size(0.0f, 3.0f);
+    AABBBatch batch;
+    for (size_t i = 0; i < count; i++) {
+        Vec3 min(position(rng), position(rng), position(rng));
+        batch.add({ min, min + Vec3(size(rng), size(rng), size(rng)) });
+    }
+    return batch;
+}
+
+TEST_CASE(TestAABBBatchMatchesScalar) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(-12.0f, 12.0f);
+    std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+    SimdLevel supported = getSupportedSimdLevel();
+
+    for (int round = 0; round < 50; round++) {
+        AABBBatch batch = randomBatch(rng, 1 + round * 3); // includes sizes that need padding
+        Vec3 origin(position(rng), position(rng), position(rng));
+        Vec3 dir(direction(rng), direction(rng), round % 5 == 0 ? 0.0f : direction(rng)); // some parallel rays
+        AABB box(origin, origin + Vec3(2, 2, 2));
+
+        std::vector<uint8_t> overlapRef(batch.maskSize()), pointRef(batch.maskSize()), rayRef(batch.maskSize());
+        std::vector<float> entryRef(batch.paddedSize());
+        setSimdLevel(SIMD_SCALAR);
+        overlapBatch(batch, box, overlapRef.data());
+        containsPointBatch(batch, origin, pointRef.data());
+        rayBatch(batch, origin, dir, 20.0f, entryRef.data(), rayRef.data());
+
+        // Reference against the single box helpers
+        for (size_t i = 0; i < batch.size(); i++) {
+            bool bit = (overlapRef[i / 8] >> (i % 8)) & 1;
+            ASSERT_EQUAL(overlaps(batch.get(i), box), bit);
+            bit = (pointRef[i / 8] >> (i % 8)) & 1;
+            ASSERT_EQUAL(contains(batch.get(i), origin), bit);
+        }
+
+        for (int level = SIMD_SSE; level <= supported; level++) {
+            std::vector<uint8_t> overlapMasks(batch.maskSize()), pointMasks(batch.maskSize()), rayMasks(batch.maskSize());
+            std::vector<float> entry(batch.paddedSize());
+            setSimdLevel((SimdLevel)level);
+            overlapBatch(batch, box, overlapMasks.data());
+            containsPointBatch(batch, origin, pointMasks.data());
+            rayBatch(batch, origin, dir, 20.0f, entry.data(), rayMasks.data());
+
+            ASSERT_TRUE(overlapMasks == overlapRef);
+            ASSERT_TRUE(pointMasks == pointRef);
+            ASSERT_TRUE(rayMasks == rayRef);
+            for (size_t i = 0; i < batch.size(); i++) {
+                if ((rayRef[i / 8] >> (i % 8)) & 1) ASSERT_EQUAL(entryRef[i], entry[i]);
+            }
+        }
+    }
+    setSimdLevel(supported);
+}
+
+TEST_CASE(TestAABBBatchRayHits) {
+    AABBBatch batch;
+    batch.add({ Vec3(2, 0, 0), Vec3(3, 1, 1) });
+    batch.add({ Vec3(5, 0, 0), Vec3(6, 1, 1) });
+    batch.add({ Vec3(5, 3, 0), Vec3(6, 4, 1) }); // off the ray
+
+    std::vector<uint8_t> masks(batch.maskSize());
+    std::vector<float> entry(batch.paddedSize());
+    rayBatch(batch, Vec3(0, 0.5f, 0.5f), Vec3(1, 0, 0), 10.0f, entry.data(), masks.data());
+    ASSERT_EQUAL(3, (int)masks[0]);
+    ASSERT_EQUAL(2.0f, entry[0]);
+    ASSERT_EQUAL(5.0f, entry[1]);
+
+    // maxT cuts off the far box
+    rayBatch(batch, Vec3(0, 0.5f, 0.5f), Vec3(1, 0, 0), 4.0f, entry.data(), masks.data());
+    ASSERT_EQUAL(1, (int)masks[0]);
+}
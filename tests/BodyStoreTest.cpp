@@ -0,0 +1,45 @@
+#include "SimpleTestFramework.h"
+#include "physics/BodyStore.h"
+#include "physics/AABBBatch.h"
+#include <cstring>
+#include <random>
+
+TEST_CASE(TestIntegrationMatchesAtEveryLevel) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> value(-20.0f, 20.0f);
+
+    BodyStore initial;
+    initial.resize(37); // not a multiple of the batch width
+    for (size_t i = 0; i < initial.size(); i++) {
+        initial.setPosition(i, Vec3(value(rng), value(rng), value(rng)));
+        initial.setVelocity(i, Vec3(value(rng), value(rng), value(rng)));
+        initial.setAcceleration(i, Vec3(0, -9.812f, value(rng)));
+        initial.deltaTime[i] = (i % 3 + 1) / 60.0f; // bodies that skipped steps move further
+    }
+
+    SimdLevel supported = getSupportedSimdLevel();
+    std::vector<BodyStore> results;
+    for (SimdLevel level : { SIMD_SCALAR, SIMD_SSE, SIMD_AVX2 }) {
+        setSimdLevel(level);
+        BodyStore store = initial;
+        integrateBodies(store, 0, 16);
+        integrateBodies(store, 16, store.size());
+        results.push_back(store);
+    }
+    setSimdLevel(supported);
+
+    // Semi-implicit Euler, the new velocity moves the body
+    Vec3 velocity = initial.getVelocity(5) + initial.getAcceleration(5) * (3.0f / 60.0f);
+    Vec3 position = initial.getPosition(5) + velocity * (3.0f / 60.0f);
+    ASSERT_TRUE(length(results[0].getPosition(5) - position) < 1e-5f);
+    ASSERT_TRUE(length(results[0].getVelocity(5) - velocity) < 1e-5f);
+
+    for (const BodyStore& store : results) {
+        for (size_t i = 0; i < store.paddedSize(); i++) {
+            ASSERT_TRUE(std::memcmp(&store.px[i], &results[0].px[i], sizeof(float)) == 0);
+            ASSERT_TRUE(std::memcmp(&store.vy[i], &results[0].vy[i], sizeof(float)) == 0);
+            ASSERT_TRUE(std::memcmp(&store.pz[i], &results[0].pz[i], sizeof(float)) == 0);
+        }
+        ASSERT_TRUE(store.px[store.paddedSize() - 1] == 0.0f); // padding stays zero
+    }
+}
@@ -0,0 +1,132 @@
+#include "SimpleTestFramework.h"
+#include "physics/SpatialHash.h"
+#include "physics/DynamicAABBTree.h"
+#include <algorithm>
+#include <random>
+
+static AABB randomBox(std::mt19937& rng, float worldSize, float maxSize) {
+    std::uniform_real_distribution<float> position(-worldSize, worldSize);
+    std::uniform_real_distribution<float> size(0.1f, maxSize);
+    Vec3 min(position(rng), position(rng), position(rng));
+    return { min, min + Vec3(size(rng), size(rng), size(rng)) };
+}
+
+// Every entity whose real bounds overlap 'query' must be reported, exactly once
+static bool matchesBruteForce(IBroadphase& broadphase, const std::vector<AABB>& boxes, const AABB& query) {
+    std::vector<Entity> found;
+    broadphase.query(query, found);
+    std::sort(found.begin(), found.end());
+    if (std::adjacent_find(found.begin(), found.end()) != found.end()) return false;
+
+    for (Entity entity = 0; entity < boxes.size(); entity++) {
+        if (overlaps(boxes[entity], query) && !std::binary_search(found.begin(), found.end(), entity)) return false;
+    }
+    return true;
+}
+
+TEST_CASE(TestBroadphaseQueries) {
+    std::mt19937 rng(42);
+    SpatialHash hash(2.0f);
+    DynamicAABBTree tree(0.1f);
+
+    // Mix of small cubes and a few very large boxes
+    std::vector<AABB> boxes;
+    for (Entity entity = 0; entity < 500; entity++) {
+        boxes.push_back(randomBox(rng, 50.0f, entity % 50 == 0 ? 40.0f : 1.0f));
+        hash.update(entity, boxes[entity]);
+        tree.update(entity, boxes[entity]);
+    }
+    ASSERT_TRUE(tree.validate());
+
+    // Move everything a little and a few entities far away
+    std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+    for (Entity entity = 0; entity < boxes.size(); entity++) {
+        Vec3 offset = (entity % 7 == 0) ? Vec3(30, 0, -30) : Vec3(step(rng), step(rng), step(rng));
+        boxes[entity] = { boxes[entity].min + offset, boxes[entity].max + offset };
+        hash.update(entity, boxes[entity]);
+        tree.update(entity, boxes[entity]);
+    }
+    ASSERT_TRUE(tree.validate());
+
+    for (int i = 0; i < 100; i++) {
+        AABB query = randomBox(rng, 60.0f, 5.0f);
+        ASSERT_TRUE(matchesBruteForce(hash, boxes, query));
+        ASSERT_TRUE(matchesBruteForce(tree, boxes, query));
+    }
+}
+
+TEST_CASE(TestAABBTreeRemoveAndBalance) {
+    DynamicAABBTree tree(0.1f);
+
+    // Inserting along a line is the worst case for an unbalanced tree
+    for (Entity entity = 0; entity < 1024; entity++) {
+        Vec3 min(entity * 2.0f, 0, 0);
+        tree.update(entity, { min, min + Vec3(1, 1, 1) });
+    }
+    ASSERT_TRUE(tree.validate());
+    ASSERT_TRUE(tree.getHeight() <= 20);
+
+    for (Entity entity = 0; entity < 1024; entity += 2) {
+        tree.remove(entity);
+    }
+    ASSERT_EQUAL(512, (int)tree.size());
+    ASSERT_TRUE(tree.validate());
+    ASSERT_TRUE(!tree.contains(0));
+    ASSERT_TRUE(tree.contains(1));
+
+    std::vector<Entity> found;
+    tree.raycast(Vec3(-1, 0.5f, 0.5f), Vec3(1, 0, 0), 8.0f, found);
+    std::sort(found.begin(), found.end());
+    ASSERT_EQUAL(2, (int)found.size()); // boxes at x = 2 and x = 6
+    ASSERT_EQUAL(1, (int)found[0]);
+    ASSERT_EQUAL(3, (int)found[1]);
+
+    tree.clear();
+    ASSERT_EQUAL(-1, tree.getHeight());
+    ASSERT_TRUE(tree.validate());
+}
+
+// Raycasts must report every entity on a matching layer that the segment passes through, exactly once,
+// and nothing from other layers
+static bool raycastMatchesBruteForce(IBroadphase& broadphase, const std::vector<AABB>& boxes,
+                                     const Vec3& origin, const Vec3& direction, float maxT, uint32_t layerMask) {
+    std::vector<Entity> found;
+    broadphase.raycast(origin, direction, maxT, found, layerMask);
+    std::sort(found.begin(), found.end());
+    if (std::adjacent_find(found.begin(), found.end()) != found.end()) return false;
+
+    Vec3 inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    for (Entity entity = 0; entity < boxes.size(); entity++) {
+        bool onLayer = ((1u << (entity % 3)) & layerMask) != 0;
+        bool reported = std::binary_search(found.begin(), found.end(), entity);
+        if (!onLayer && reported) return false;
+        if (onLayer && rayOverlaps(boxes[entity], origin, inverseDirection, maxT) && !reported) return false;
+    }
+    return true;
+}
+
+TEST_CASE(TestBroadphaseRaycastsAndLayers) {
+    std::mt19937 rng(7);
+    SpatialHash hash(2.0f);
+    DynamicAABBTree tree(0.1f);
+
+    std::vector<AABB> boxes;
+    for (Entity entity = 0; entity < 500; entity++) {
+        boxes.push_back(randomBox(rng, 30.0f, entity % 50 == 0 ? 20.0f : 1.0f));
+        hash.update(entity, boxes[entity]);
+        tree.update(entity, boxes[entity]);
+        hash.setLayers(entity, 1u << (entity % 3));
+        tree.setLayers(entity, 1u << (entity % 3));
+    }
+    ASSERT_TRUE(tree.validate());
+
+    std::uniform_real_distribution<float> coordinate(-35.0f, 35.0f);
+    for (int i = 0; i < 200; i++) {
+        Vec3 origin(coordinate(rng), coordinate(rng), coordinate(rng));
+        Vec3 direction = normalise(Vec3(coordinate(rng), coordinate(rng), coordinate(rng)));
+        if (i % 10 == 0) direction = Vec3(0, 0, 1); // along a cell boundary plane on two axes
+        uint32_t layerMask = (i % 2) ? COLLISION_LAYER_ALL : 0b101;
+        ASSERT_TRUE(raycastMatchesBruteForce(hash, boxes, origin, direction, 40.0f, layerMask));
+        ASSERT_TRUE(raycastMatchesBruteForce(tree, boxes, origin, direction, 40.0f, layerMask));
+    }
+}
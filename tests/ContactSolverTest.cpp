@@ -0,0 +1,83 @@
+#include "SimpleTestFramework.h"
+#include "TestScenes.h"
+#include "physics/ContactSolver.h"
+#include "systems/PhysicsSystem.h"
+#include <cmath>
+
+TEST_CASE(TestWarmStartedContactConverges) {
+    ContactSettings settings;
+    float deltaTime = 1.0f / 60.0f;
+
+    // A body resting on the ground, gravity already added to its velocity
+    BodyStore store;
+    store.resize(1);
+    store.inverseMass[0] = 1.0f;
+    store.deltaTime[0] = deltaTime;
+    Contact contact;
+    contact.bodyA = 0;
+    contact.bodyB = -1;
+    contact.key = 0;
+    contact.normal = Vec3(0, 1, 0);
+    contact.separation = settings.restOffset;
+
+    store.setVelocity(0, Vec3(0, -9.812f * deltaTime, 0));
+    prepareContacts(store, &contact, 1, settings);
+    int cold = solveContacts(store, &contact, 1, settings);
+    ASSERT_TRUE(std::fabs(store.getVelocity(0).y) < 1e-4f);
+
+    // Next step the carried impulse already cancels gravity
+    store.setVelocity(0, Vec3(0, -9.812f * deltaTime, 0));
+    prepareContacts(store, &contact, 1, settings);
+    int warm = solveContacts(store, &contact, 1, settings);
+    ASSERT_EQUAL(1, warm);
+    ASSERT_TRUE(warm < cold);
+    ASSERT_TRUE(std::fabs(store.getVelocity(0).y) < 1e-4f);
+}
+
+TEST_CASE(TestStackStaysUpAndSleeps) {
+    Registry& registry = Registry::getInstance();
+    std::vector<Entity> ground = buildFloor(registry);
+
+    std::vector<Entity> stack;
+    for (int i = 0; i < 6; i++) {
+        Entity body = registry.createEntity();
+        registry.addComponent(body, Transform(Vec3(0.5f, 1.0f + i * 1.001f, 0.5f)));
+        registry.addComponent(body, Physics(Vec3(0, 0, 0), Vec3(0, -9.812f, 0), 1.0f));
+        stack.push_back(body);
+    }
+
+    PhysicsSystem physics;
+    for (int step = 0; step < 180; step++) physics.update(1.0f / 60.0f);
+
+    // Every body still sits on the one below, the old bounces shook stacks apart
+    for (int i = 0; i < 6; i++) {
+        Vec3 position = registry.getComponent<Transform>(stack[i]).position;
+        ASSERT_TRUE(std::fabs(position.x - 0.5f) < 1e-3f && std::fabs(position.z - 0.5f) < 1e-3f);
+        ASSERT_TRUE(position.y > 1.0f + i && position.y < 1.02f + i);
+        ASSERT_TRUE(registry.getComponent<Physics>(stack[i]).isSleeping);
+    }
+
+    for (Entity entity : ground) registry.destroyEntity(entity);
+    for (Entity body : stack) registry.destroyEntity(body);
+}
+
+TEST_CASE(TestFrictionStopsSlidingBody) {
+    Registry& registry = Registry::getInstance();
+    std::vector<Entity> ground = buildFloor(registry);
+
+    Entity body = registry.createEntity();
+    registry.addComponent(body, Transform(Vec3(-2.5f, 1.001f, 0.5f)));
+    registry.addComponent(body, Physics(Vec3(3, 0, 0), Vec3(0, -9.812f, 0), 1.0f));
+
+    PhysicsSystem physics;
+    for (int step = 0; step < 120; step++) physics.update(1.0f / 60.0f);
+
+    // Slides about v^2 / (2 * friction * g) = 0.9 units and stays on the ground
+    Vec3 position = registry.getComponent<Transform>(body).position;
+    ASSERT_TRUE(position.x > -2.0f && position.x < -1.0f);
+    ASSERT_TRUE(position.y > 1.0f && position.y < 1.01f);
+    ASSERT_TRUE(std::fabs(registry.getComponent<Physics>(body).velocity.x) < 1e-3f);
+
+    for (Entity entity : ground) registry.destroyEntity(entity);
+    registry.destroyEntity(body);
+}
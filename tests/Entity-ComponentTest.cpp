@@ -1,18 +1,18 @@
 #include "SimpleTestFramework.h"
-#include "managers/ComponentManager.h"
 #include "managers/EntityManager.h"
 
-EntityManager& EM = EntityManager::getInstance();
-
 TEST_CASE(TestCreate) {
+    EntityManager EM;
     Entity entity;
     for (int i = 0; i < 10000; i++) {
         entity = EM.createEntity();
-        ASSERT_EQUAL(entity, i << 16); // versipn 1
+        ASSERT_EQUAL(entity, i << 16); // version 0
     }
 }
 
 TEST_CASE(TestDestroy) {
+    EntityManager EM;
+    for (int i = 0; i < 10; i++) EM.createEntity();
     for (int i = 0; i < 10; i++) {
         ASSERT_TRUE(EM.isEntityAlive(i << 16)); // alive
         EM.destroyEntity(i << 16); // destroy entities
@@ -21,17 +21,15 @@ TEST_CASE(TestDestroy) {
 }
 
 TEST_CASE(TestReuse) {
+    EntityManager EM;
+    for (int i = 0; i < 10000; i++) EM.createEntity();
+    for (int i = 0; i < 10; i++) EM.destroyEntity(i << 16);
+
     Entity entity;
     for (int i = 0; i < 10; i++) {
         entity = EM.createEntity();
-        ASSERT_EQUAL(entity, (i << 16) + 1); // version 2
+        ASSERT_EQUAL(entity, (i << 16) + 1); // version 1
     }
     entity = EM.createEntity();
-    ASSERT_EQUAL(entity, (10000 << 16)); // goes back to where version 1 left off
-}   
-    
-
-int main() {
-    TestFramework::getInstance().runAllTests();
-    return 0;
-}
\ No newline at end of file
+    ASSERT_EQUAL(entity, (10000 << 16)); // goes back to where the new indices left off
+}
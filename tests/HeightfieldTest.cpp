@@ -0,0 +1,90 @@
+#include "SimpleTestFramework.h"
+#include "systems/PhysicsSystem.h"
+
+TEST_CASE(TestHeightfieldHeightAndRaycast) {
+    // Rises by one per sample along x, cells are 2 wide so the surface is y = x / 2
+    std::vector<float> heights = { 0, 1, 2, 0, 1, 2, 0, 1, 2 };
+    Heightfield field(3, 3, 2.0f, Vec3(0, 0, 0), heights);
+
+    float height;
+    Vec3 normal;
+    ASSERT_TRUE(field.getHeight(1.0f, 3.0f, height, &normal));
+    ASSERT_TRUE(std::fabs(height - 0.5f) < 1e-5f);
+    ASSERT_TRUE(normal.x < 0.0f && normal.y > 0.0f && std::fabs(normal.z) < 1e-5f);
+    ASSERT_TRUE(!field.getHeight(5.0f, 1.0f, height));
+
+    HeightfieldHit hit;
+    ASSERT_TRUE(field.raycast(Vec3(3, 5, 1), Vec3(0, -1, 0), 10.0f, hit));
+    ASSERT_TRUE(std::fabs(hit.t - 3.5f) < 1e-4f);
+    ASSERT_TRUE(!field.raycast(Vec3(3, 5, 1), Vec3(0, -1, 0), 3.0f, hit));
+    ASSERT_TRUE(!field.raycast(Vec3(-1, 5, 1), Vec3(-1, 0, 0), 10.0f, hit));
+
+    // Along the slope from above it, and from below the surface
+    ASSERT_TRUE(field.raycast(Vec3(0, 1, 1), Vec3(1, 0, 0), 10.0f, hit));
+    ASSERT_TRUE(std::fabs(hit.point.x - 2.0f) < 1e-4f);
+    ASSERT_TRUE(field.raycast(Vec3(3, 0, 1), Vec3(0, 1, 0), 10.0f, hit));
+    ASSERT_EQUAL(0.0f, hit.t);
+
+    ASSERT_TRUE(field.overlaps(AABB(Vec3(2.5f, 1.0f, 1.0f), Vec3(3.5f, 2.0f, 2.0f))));
+    ASSERT_TRUE(!field.overlaps(AABB(Vec3(0.5f, 1.0f, 1.0f), Vec3(1.5f, 2.0f, 2.0f))));
+    ASSERT_TRUE(field.overlaps(Vec3(2, 1.5f, 2), 0.5f));
+    ASSERT_TRUE(!field.overlaps(Vec3(2, 1.5f, 2), 0.3f));
+}
+
+TEST_CASE(TestHeightfieldFromMesh) {
+    // Vertices on a grid are taken as the samples
+    std::vector<Vec3> grid;
+    for (int z = 0; z < 3; z++) {
+        for (int x = 0; x < 4; x++) grid.push_back(Vec3(x * 0.5f, (float)x, z * 0.5f));
+    }
+    Heightfield copied(grid, {}, 1.0f);
+    ASSERT_EQUAL(4, copied.getWidth());
+    ASSERT_EQUAL(3, copied.getDepth());
+    ASSERT_EQUAL(0.5f, copied.getCellSize());
+    ASSERT_EQUAL(3.0f, copied.getSample(3, 2));
+
+    // Any other mesh is sampled from above, the highest triangle wins
+    std::vector<Vec3> positions = { Vec3(0, 0, 0), Vec3(8, 4, 0), Vec3(0, 0, 8), Vec3(0, 1, 0), Vec3(4, 1, 0), Vec3(0, 1, 4) };
+    Heightfield sampled(positions, { 0, 1, 2, 3, 4, 5 }, 1.0f);
+    ASSERT_EQUAL(9, sampled.getWidth());
+    float height;
+    ASSERT_TRUE(sampled.getHeight(1.0f, 1.0f, height));
+    ASSERT_TRUE(std::fabs(height - 1.0f) < 1e-5f);
+    ASSERT_TRUE(sampled.getHeight(5.0f, 1.0f, height));
+    ASSERT_TRUE(std::fabs(height - 2.5f) < 1e-5f);
+    ASSERT_TRUE(sampled.getHeight(7.0f, 7.0f, height)); // uncovered
+    ASSERT_EQUAL(0.0f, height);
+}
+
+TEST_CASE(TestBodyRestsOnTerrain) {
+    Registry& registry = Registry::getInstance();
+
+    std::vector<float> heights(11 * 11, 0.0f);
+    auto field = std::make_shared<Heightfield>(11, 11, 1.0f, Vec3(-5, 0, -5), heights);
+    Entity terrain = registry.createEntity();
+    registry.addComponent(terrain, Transform(Vec3(0, 2, 0)));
+    registry.addComponent(terrain, Collider(COLLISION_LAYER_DEFAULT, field));
+
+    Entity body = registry.createEntity();
+    registry.addComponent(body, Transform(Vec3(0.3f, 2.5f, 0.3f)));
+    registry.addComponent(body, Physics(Vec3(0, 0, 0), Vec3(0, -9.812f, 0), 1.0f));
+
+    // Bounces a few times, then settles and sleeps on the surface
+    PhysicsSystem physics;
+    for (int step = 0; step < 240; step++) physics.update(1.0f / 60.0f);
+    float y = registry.getComponent<Transform>(body).position.y;
+    ASSERT_TRUE(y > 1.99f && y < 2.01f);
+    ASSERT_EQUAL(1, (int)physics.getSleepingCount());
+
+    QueryHit hit;
+    ASSERT_TRUE(physics.raycast(Vec3(3, 10, 3), Vec3(0, -1, 0), 20.0f, hit));
+    ASSERT_EQUAL(terrain, hit.entity);
+    ASSERT_TRUE(std::fabs(hit.distance - 8.0f) < 1e-4f);
+
+    std::vector<Entity> found;
+    physics.overlapBox(AABB(Vec3(-3, 1.5f, -3), Vec3(-2, 2.5f, -2)), found);
+    ASSERT_EQUAL(1, (int)found.size());
+
+    registry.destroyEntity(terrain);
+    registry.destroyEntity(body);
+}
@@ -0,0 +1,45 @@
+#include "SimpleTestFramework.h"
+#include "systems/PhysicsSystem.h"
+
+TEST_CASE(TestFastBodyDoesNotTunnel) {
+    Registry& registry = Registry::getInstance();
+
+    // Off the grid, so the wall is a broadphase collider and not a voxel
+    Entity wall = registry.createEntity();
+    registry.addComponent(wall, Transform(Vec3(2.5f, 0.5f, 0.5f)));
+
+    // Moves 5 units per step, the old end point test jumped straight over the wall
+    Entity body = registry.createEntity();
+    registry.addComponent(body, Transform(Vec3(0, 1, 1)));
+    registry.addComponent(body, Physics(Vec3(300, 0, 0), Vec3(0, 0, 0), 1.0f));
+
+    PhysicsSystem physics;
+    for (int frame = 0; frame < 3; frame++) {
+        physics.update(1.0f / 60.0f);
+        ASSERT_TRUE(registry.getComponent<Transform>(body).position.x < 2.5f);
+    }
+    ASSERT_TRUE(registry.getComponent<Physics>(body).velocity.x < 0.0f);
+
+    registry.destroyEntity(wall);
+    registry.destroyEntity(body);
+}
+
+TEST_CASE(TestFastBodyBouncesWithinOneStep) {
+    Registry& registry = Registry::getInstance();
+
+    // On the grid this time, fast bodies find static cubes with swept moves rather than contacts
+    Entity wall = registry.createEntity();
+    registry.addComponent(wall, Transform(Vec3(2, 1, 1)));
+
+    Entity body = registry.createEntity();
+    registry.addComponent(body, Transform(Vec3(0, 1.5f, 1.5f)));
+    registry.addComponent(body, Physics(Vec3(300, 0, 0), Vec3(0, 0, 0), 1.0f));
+
+    // Sub-steps carry on after the bounce instead of losing the rest of the step at the wall
+    PhysicsSystem physics;
+    physics.update(1.0f / 60.0f);
+    ASSERT_TRUE(registry.getComponent<Transform>(body).position.x < 1.0f);
+
+    registry.destroyEntity(wall);
+    registry.destroyEntity(body);
+}
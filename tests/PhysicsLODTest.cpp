@@ -0,0 +1,46 @@
+#include "SimpleTestFramework.h"
+#include "systems/PhysicsSystem.h"
+
+TEST_CASE(TestLODBandHysteresis) {
+    std::vector<PhysicsLODBand> bands = { { 0.0f, 1, false }, { 10.0f, 2, false }, { 20.0f, 4, true } };
+
+    // Bodies have to get 10% past a boundary to change band
+    ASSERT_EQUAL(0, selectLODBand(bands, 10.5f, 0, 0.1f));
+    ASSERT_EQUAL(1, selectLODBand(bands, 11.5f, 0, 0.1f));
+    ASSERT_EQUAL(1, selectLODBand(bands, 9.5f, 1, 0.1f));
+    ASSERT_EQUAL(0, selectLODBand(bands, 8.5f, 1, 0.1f));
+    ASSERT_EQUAL(2, selectLODBand(bands, 50.0f, 0, 0.1f));
+    ASSERT_EQUAL(0, selectLODBand(bands, 1.0f, 2, 0.1f));
+}
+
+TEST_CASE(TestFarBodyStepsLessButKeepsUp) {
+    Registry& registry = Registry::getInstance();
+
+    Entity near = registry.createEntity();
+    registry.addComponent(near, Transform(Vec3(0, 50, 0)));
+    registry.addComponent(near, Physics(Vec3(0, 0, 0), Vec3(0, -9.812f, 0), 1.0f));
+
+    Entity far = registry.createEntity();
+    registry.addComponent(far, Transform(Vec3(300, 50, 0)));
+    registry.addComponent(far, Physics(Vec3(0, 0, 0), Vec3(0, -9.812f, 0), 1.0f));
+
+    PhysicsSystem physics;
+    physics.setLODCamera(std::make_shared<Camera>(Vec3(0, 50, 0), Vec3(0, 1, 0), 0.0f, 0.0f, 90.0f, 1.0f, 0.1f, 100.0f));
+
+    int stepped = 0;
+    for (int step = 0; step < 60; step++) {
+        physics.update(1.0f / 60.0f);
+        stepped += physics.getStats().steppedBodies;
+    }
+    ASSERT_TRUE(stepped > 60 && stepped < 120 - 30);
+    ASSERT_EQUAL(1, (int)physics.getStats().simplifiedBodies);
+
+    // Larger steps lose no time, the far body falls about as far
+    float nearY = registry.getComponent<Transform>(near).position.y;
+    float farY = registry.getComponent<Transform>(far).position.y;
+    ASSERT_TRUE(nearY < 46.0f);
+    ASSERT_TRUE(std::fabs(nearY - farY) < 0.2f);
+
+    registry.destroyEntity(near);
+    registry.destroyEntity(far);
+}
@@ -0,0 +1,107 @@
+#include "SimpleTestFramework.h"
+#include "TestScenes.h"
+#include "systems/PhysicsSystem.h"
+
+static Entity addBody(Registry& registry, Vec3 position) {
+    Entity entity = registry.createEntity();
+    registry.addComponent(entity, Transform(position));
+    registry.addComponent(entity, Physics(Vec3(0, 0, 0), Vec3(0, -9.812f, 0), 1.0f));
+    return entity;
+}
+
+static void simulate(PhysicsSystem& physics, float seconds) {
+    for (float t = 0; t < seconds; t += 1.0f / 60.0f) {
+        physics.update(1.0f / 60.0f);
+    }
+}
+
+TEST_CASE(TestBodyFallsAsleepAndWakes) {
+    Registry& registry = Registry::getInstance();
+    std::vector<Entity> floor = buildFloor(registry);
+    Entity body = addBody(registry, Vec3(0.5f, 3, 0.5f));
+
+    PhysicsSystem physics;
+    simulate(physics, 10.0f);
+    ASSERT_TRUE(registry.getComponent<Physics>(body).isSleeping);
+    ASSERT_EQUAL(0, (int)physics.getAwakeCount());
+    float restingY = registry.getComponent<Transform>(body).position.y;
+    ASSERT_TRUE(restingY > 0.99f && restingY < 1.1f);
+
+    // An impulse wakes it, it flies up and settles again
+    physics.applyImpulse(body, Vec3(0, 5, 0));
+    ASSERT_TRUE(!registry.getComponent<Physics>(body).isSleeping);
+    physics.update(1.0f / 60.0f);
+    ASSERT_TRUE(registry.getComponent<Transform>(body).position.y > restingY);
+    simulate(physics, 10.0f);
+    ASSERT_TRUE(registry.getComponent<Physics>(body).isSleeping);
+
+    // Removing the floor under it wakes it up
+    for (Entity entity : floor) registry.destroyEntity(entity);
+    physics.update(1.0f / 60.0f);
+    ASSERT_TRUE(!registry.getComponent<Physics>(body).isSleeping);
+
+    registry.destroyEntity(body);
+}
+
+TEST_CASE(TestStackSleepsAndWakesAsIsland) {
+    Registry& registry = Registry::getInstance();
+    std::vector<Entity> floor = buildFloor(registry);
+    Entity bottom = addBody(registry, Vec3(0.5f, 1.5f, 0.5f));
+    Entity top = addBody(registry, Vec3(0.5f, 3.0f, 0.5f));
+
+    PhysicsSystem physics;
+    simulate(physics, 10.0f);
+    ASSERT_TRUE(registry.getComponent<Physics>(bottom).isSleeping);
+    ASSERT_TRUE(registry.getComponent<Physics>(top).isSleeping);
+    ASSERT_TRUE(registry.getComponent<Transform>(top).position.y > 1.9f); // still on top of the other body
+
+    // Touching the bottom body wakes the one resting on it too
+    physics.wake(bottom);
+    ASSERT_TRUE(!registry.getComponent<Physics>(top).isSleeping);
+    ASSERT_EQUAL(0, (int)physics.getSleepingCount());
+
+    for (Entity entity : floor) registry.destroyEntity(entity);
+    registry.destroyEntity(bottom);
+    registry.destroyEntity(top);
+}
+
+TEST_CASE(TestRemovingCollidersWakesOnlyBodiesTouchingThem) {
+    Registry& registry = Registry::getInstance();
+    std::vector<Entity> floor;
+    for (int x = 0; x < 12; x++) {
+        for (int z = 0; z < 12; z++) {
+            Entity entity = registry.createEntity();
+            registry.addComponent(entity, Transform(Vec3(x, 0, z)));
+            floor.push_back(entity);
+        }
+    }
+    Entity near = addBody(registry, Vec3(0.5f, 1.5f, 0.5f));
+    Entity far = addBody(registry, Vec3(8.5f, 1.5f, 8.5f));
+    Entity pickup = registry.createEntity();
+    registry.addComponent(pickup, Transform(Vec3(20, 5, 20)));
+
+    PhysicsSystem physics;
+    simulate(physics, 10.0f);
+    ASSERT_TRUE(registry.getComponent<Physics>(near).isSleeping);
+    ASSERT_TRUE(registry.getComponent<Physics>(far).isSleeping);
+
+    // Despawning something nobody rests on, or a body in flight, wakes nothing
+    Entity projectile = addBody(registry, Vec3(5, 30, 5));
+    physics.update(1.0f / 60.0f);
+    registry.destroyEntity(projectile);
+    registry.destroyEntity(pickup);
+    physics.update(1.0f / 60.0f);
+    ASSERT_EQUAL(2, (int)physics.getSleepingCount());
+
+    // A cube under one body only wakes that one
+    registry.destroyEntity(floor[1 * 12 + 1]);
+    physics.update(1.0f / 60.0f);
+    ASSERT_TRUE(!registry.getComponent<Physics>(near).isSleeping);
+    ASSERT_TRUE(registry.getComponent<Physics>(far).isSleeping);
+
+    for (size_t i = 0; i < floor.size(); i++) {
+        if (i != 1 * 12 + 1) registry.destroyEntity(floor[i]);
+    }
+    registry.destroyEntity(near);
+    registry.destroyEntity(far);
+}
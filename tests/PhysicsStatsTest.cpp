@@ -0,0 +1,53 @@
+#include "SimpleTestFramework.h"
+#include "systems/PhysicsSystem.h"
+#include <sstream>
+
+TEST_CASE(TestPhysicsStatsAndLog) {
+    Registry& registry = Registry::getInstance();
+    std::vector<Entity> entities;
+    for (int x = -2; x <= 2; x++) {
+        Entity cube = registry.createEntity();
+        registry.addComponent(cube, Transform(Vec3(x, 0, 0)));
+        entities.push_back(cube);
+    }
+    Entity body = registry.createEntity();
+    registry.addComponent(body, Transform(Vec3(0.5f, 1.5f, 0.5f)));
+    registry.addComponent(body, Physics(Vec3(0, 0, 0), Vec3(0, -9.812f, 0), 1.0f));
+    entities.push_back(body);
+
+    // Fast enough to be split into sub-steps
+    Entity fast = registry.createEntity();
+    registry.addComponent(fast, Transform(Vec3(0.5f, 5.0f, 10.0f)));
+    registry.addComponent(fast, Physics(Vec3(0, 0, 120), Vec3(0, 0, 0), 1.0f));
+    entities.push_back(fast);
+
+    PhysicsSystem physics;
+    physics.setStatsLogSize(20);
+    for (int step = 0; step < 30; step++) physics.update(1.0f / 60.0f);
+
+    const PhysicsStats& stats = physics.getStats();
+    ASSERT_EQUAL(29, (int)stats.step);
+    ASSERT_EQUAL(2, (int)stats.awakeBodies);
+    ASSERT_EQUAL(5, (int)stats.staticCubes);
+    ASSERT_EQUAL(1, (int)stats.substeppedBodies);
+    ASSERT_TRUE(stats.moves > stats.awakeBodies);
+    ASSERT_TRUE(stats.totalMs >= stats.collideMs);
+
+    // The body lands on the cubes within the logged steps
+    int contacts = 0;
+    std::vector<PhysicsStats> log = physics.getStatsLog();
+    ASSERT_EQUAL(20, (int)log.size());
+    for (size_t i = 0; i < log.size(); i++) {
+        ASSERT_EQUAL(10 + (int)i, (int)log[i].step);
+        contacts += log[i].solverContacts;
+        if (log[i].solverContacts) ASSERT_TRUE(log[i].solverIterations > 0);
+    }
+    ASSERT_TRUE(contacts > 0);
+
+    std::ostringstream out;
+    writeStatsCSV(out, log);
+    std::string csv = out.str();
+    ASSERT_EQUAL(21, (int)std::count(csv.begin(), csv.end(), '\n'));
+
+    for (Entity entity : entities) registry.destroyEntity(entity);
+}
@@ -0,0 +1,86 @@
+#include "SimpleTestFramework.h"
+#include "core/ThreadPool.h"
+#include "systems/PhysicsSystem.h"
+#include <cstring>
+
+TEST_CASE(TestParallelForCoversEveryIndexOnce) {
+    // Checked after the loop, an assertion failing on a worker thread would abort the whole run
+    std::vector<int> visits(10000, 0);
+    std::vector<uint8_t> badRange(visits.size(), 0); // by the range's first index
+    ThreadPool::getInstance().parallelFor(visits.size(), 37, [&](size_t begin, size_t end) {
+        if (begin >= end || end - begin > 37) {
+            if (begin < badRange.size()) badRange[begin] = 1;
+            return;
+        }
+        for (size_t i = begin; i < end; i++) visits[i]++;
+    });
+
+    for (uint8_t bad : badRange) ASSERT_EQUAL(0, (int)bad);
+    for (int count : visits) ASSERT_EQUAL(1, count);
+}
+
+struct BodyState {
+    Vec3 position;
+    Physics physics;
+};
+
+static std::vector<BodyState> saveBodies(Registry& registry, const std::vector<Entity>& bodies) {
+    std::vector<BodyState> states;
+    for (Entity body : bodies) {
+        states.push_back({ registry.getComponent<Transform>(body).position, registry.getComponent<Physics>(body) });
+    }
+    return states;
+}
+
+static void restoreBodies(Registry& registry, const std::vector<Entity>& bodies, const std::vector<BodyState>& states) {
+    for (size_t i = 0; i < bodies.size(); i++) {
+        registry.getComponent<Transform>(bodies[i]).position = states[i].position;
+        registry.getComponent<Physics>(bodies[i]) = states[i].physics;
+    }
+}
+
+static bool sameBits(const Vec3& a, const Vec3& b) {
+    return std::memcmp(&a, &b, sizeof(Vec3)) == 0;
+}
+
+TEST_CASE(TestThreadedStepMatchesSingleThread) {
+    Registry& registry = Registry::getInstance();
+    std::vector<Entity> entities;
+    for (int x = -8; x <= 8; x++) {
+        for (int z = -8; z <= 8; z++) {
+            Entity entity = registry.createEntity();
+            registry.addComponent(entity, Transform(Vec3(x, 0, z)));
+            entities.push_back(entity);
+        }
+    }
+
+    // Bodies packed close enough to run into each other
+    std::vector<Entity> bodies;
+    for (int i = 0; i < 600; i++) {
+        Vec3 position(-6 + (i % 10) * 1.3f, 2 + (i / 100) * 1.3f, -6 + ((i / 10) % 10) * 1.3f);
+        Vec3 velocity((i * 7 % 11) - 5.0f, (i * 3 % 7) - 3.0f, (i * 5 % 13) - 6.0f);
+        Entity body = registry.createEntity();
+        registry.addComponent(body, Transform(position));
+        registry.addComponent(body, Physics(velocity, Vec3(0, -9.812f, 0), 1.0f));
+        bodies.push_back(body);
+    }
+    std::vector<BodyState> start = saveBodies(registry, bodies);
+
+    std::vector<std::vector<BodyState>> results;
+    for (unsigned threads : { 1u, 0u }) {
+        restoreBodies(registry, bodies, start);
+        PhysicsSystem physics;
+        physics.setMaxThreads(threads);
+        for (int frame = 0; frame < 120; frame++) physics.update(1.0f / 60.0f);
+        results.push_back(saveBodies(registry, bodies));
+    }
+
+    for (size_t i = 0; i < bodies.size(); i++) {
+        ASSERT_TRUE(sameBits(results[0][i].position, results[1][i].position));
+        ASSERT_TRUE(sameBits(results[0][i].physics.velocity, results[1][i].physics.velocity));
+        ASSERT_EQUAL(results[0][i].physics.isSleeping, results[1][i].physics.isSleeping);
+    }
+
+    for (Entity entity : entities) registry.destroyEntity(entity);
+    for (Entity body : bodies) registry.destroyEntity(body);
+}
@@ -0,0 +1,130 @@
+#include "SimpleTestFramework.h"
+#include "graphics/RenderScene.h"
+#include "systems/PhysicsSystem.h"
+#include <algorithm>
+
+// Headless shapes, only parsed
+static std::shared_ptr<Shape> makeShape() {
+    return std::make_shared<Shape>("lib/objects/cube.obj", true, false);
+}
+
+static uint32_t batchOf(const RenderScene& scene, const std::shared_ptr<Shape>& shape) {
+    const std::vector<RenderScene::Batch>& batches = scene.getBatches();
+    for (uint32_t i = 0; i < batches.size(); i++) {
+        if (batches[i].shape == shape) return i;
+    }
+    return UINT32_MAX;
+}
+
+TEST_CASE(TestRenderSceneUpdatesOnlyChangedSlots) {
+    Registry& registry = Registry::getInstance();
+    auto cube = makeShape(), other = makeShape();
+
+    RenderScene scene;
+    scene.update();
+    size_t before = scene.getSlotCount();
+
+    std::vector<Entity> entities;
+    for (int i = 0; i < 4; i++) {
+        Entity entity = registry.createEntity();
+        registry.addComponent(entity, Transform(Vec3((float)i, 0, 0)));
+        registry.addComponent(entity, Material(i < 3 ? cube : other));
+        entities.push_back(entity);
+    }
+    scene.update();
+    ASSERT_EQUAL(before + 4, scene.getSlotCount());
+    ASSERT_EQUAL(4, (int)scene.getInstanceCount());
+    uint32_t cubeBatch = batchOf(scene, cube);
+    ASSERT_EQUAL(3, (int)scene.getBatches()[cubeBatch].slots.size());
+
+    // Nothing changed, nothing to upload
+    scene.update();
+    ASSERT_EQUAL(0, (int)scene.getRuns().size());
+
+    // A moved entity is written again with its new transform
+    registry.getComponent<Transform>(entities[1]).position = Vec3(5, 6, 7);
+    registry.markChanged(entities[1]);
+    scene.update();
+    ASSERT_EQUAL(1, (int)scene.getRuns().size());
+    ASSERT_EQUAL(1, (int)scene.getInstanceCount());
+    InstanceData instance;
+    scene.writeInstances(&instance);
+    ASSERT_EQUAL(6.0f, instance.matWorld[3][1]);
+
+    // The last slot fills the hole of a destroyed entity
+    registry.destroyEntity(entities[0]);
+    scene.update();
+    ASSERT_EQUAL(2, (int)scene.getBatches()[cubeBatch].slots.size());
+    ASSERT_EQUAL(1, (int)scene.getRuns().size());
+    ASSERT_EQUAL(0, (int)scene.getRuns()[0].slot);
+    scene.writeInstances(&instance);
+    ASSERT_EQUAL(2.0f, instance.matWorld[3][0]);
+
+    for (size_t i = 1; i < entities.size(); i++) registry.destroyEntity(entities[i]);
+    scene.update();
+    ASSERT_EQUAL(before, scene.getSlotCount());
+}
+
+TEST_CASE(TestRenderSceneMovesEntitiesBetweenBatches) {
+    Registry& registry = Registry::getInstance();
+    auto cube = makeShape(), other = makeShape(), third = makeShape();
+
+    RenderScene scene;
+    Entity a = registry.createEntity();
+    registry.addComponent(a, Transform());
+    registry.addComponent(a, Material(cube));
+    Entity b = registry.createEntity();
+    registry.addComponent(b, Transform());
+    registry.addComponent(b, Material(other));
+    scene.update();
+    uint32_t otherBatch = batchOf(scene, other);
+
+    // Changing the shape in place moves the entity, the emptied batch is free for the next shape
+    registry.getComponent<Material>(b).shape = cube;
+    registry.markChanged(b);
+    scene.update();
+    ASSERT_EQUAL(2, (int)scene.getBatches()[batchOf(scene, cube)].slots.size());
+    ASSERT_TRUE(!scene.getBatches()[otherBatch].shape);
+
+    // The scene hands the shape it let go of to the packet, which drops it after submitting
+    FramePacket packet;
+    scene.takeReleased(packet.released);
+    ASSERT_EQUAL(1, (int)packet.released.size());
+    ASSERT_TRUE(packet.released[0] == other);
+    packet.batches.resize(1);
+    packet.batches[0].shape = cube;
+    packet.batchCount = 1;
+    packet.clear();
+    ASSERT_EQUAL(2, (int)packet.released.size());
+    ASSERT_TRUE(!packet.batches[0].shape);
+
+    registry.removeComponent<Material>(a);
+    registry.addComponent(a, Material(third));
+    scene.update();
+    ASSERT_EQUAL(otherBatch, batchOf(scene, third));
+    ASSERT_EQUAL(1, (int)scene.getBatches()[otherBatch].slots.size());
+
+    registry.destroyEntity(a);
+    registry.destroyEntity(b);
+}
+
+TEST_CASE(TestPhysicsStepMarksOnlyItsBodies) {
+    Registry& registry = Registry::getInstance();
+    Entity body = registry.createEntity();
+    registry.addComponent(body, Transform(Vec3(0, 10, 0)));
+    registry.addComponent(body, Physics(Vec3(0, 0, 0), Vec3(0, -9.812f, 0), 1.0f));
+
+    PhysicsSystem physics;
+    physics.update(1.0f / 60.0f);
+    std::vector<Entity> changed;
+    registry.takeChanged(changed);
+
+    // One body in a store padded to a whole SIMD group, only the body itself is uploaded again
+    physics.update(1.0f / 60.0f);
+    registry.takeChanged(changed);
+    ASSERT_EQUAL(1, (int)changed.size());
+    ASSERT_EQUAL(body, changed[0]);
+
+    registry.destroyEntity(body);
+    registry.takeChanged(changed);
+}
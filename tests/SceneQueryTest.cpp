@@ -0,0 +1,68 @@
+#include "SimpleTestFramework.h"
+#include "systems/PhysicsSystem.h"
+
+#define LAYER_PLAYER (1u << 1)
+
+TEST_CASE(TestSceneQueries) {
+    Registry& registry = Registry::getInstance();
+    std::vector<Entity> entities;
+    auto add = [&](Vec3 position) {
+        Entity entity = registry.createEntity();
+        registry.addComponent(entity, Transform(position));
+        entities.push_back(entity);
+        return entity;
+    };
+
+    // A wall of static cubes at x = 5, a crate off the grid in front of it and a player that is further away
+    for (int y = 0; y < 3; y++) {
+        for (int z = -1; z <= 1; z++) add(Vec3(5, y, z));
+    }
+    Entity crate = add(Vec3(2.5f, 0.0f, 0.0f));
+    Entity player = add(Vec3(0, 0, 3));
+    registry.addComponent(player, Collider(LAYER_PLAYER));
+
+    PhysicsSystem physics;
+    QueryHit hit;
+
+    ASSERT_TRUE(physics.raycast(Vec3(0, 0.5f, 0.5f), Vec3(2, 0, 0), 10.0f, hit));
+    ASSERT_EQUAL(crate, hit.entity);
+    ASSERT_TRUE(std::abs(hit.distance - 2.5f) < 1e-4f);
+    ASSERT_TRUE(hit.normal.x == -1.0f);
+
+    // Skipping the default layer ignores crate and wall
+    ASSERT_TRUE(!physics.raycast(Vec3(0, 0.5f, 0.5f), Vec3(1, 0, 0), 10.0f, hit, LAYER_PLAYER));
+
+    // Above the crate the wall is hit
+    ASSERT_TRUE(physics.raycast(Vec3(0, 1.5f, 0.5f), Vec3(1, 0, 0), 10.0f, hit));
+    ASSERT_TRUE(std::abs(hit.distance - 5.0f) < 1e-4f);
+
+    // A half unit box sliding along x stops against the crate with its max side
+    ASSERT_TRUE(physics.sweep({ Vec3(0, 0.25f, 0.25f), Vec3(0.5f, 0.75f, 0.75f) }, Vec3(1, 0, 0), 10.0f, hit));
+    ASSERT_EQUAL(crate, hit.entity);
+    ASSERT_TRUE(std::abs(hit.distance - 2.0f) < 1e-4f);
+
+    std::vector<Entity> found;
+    physics.overlapSphere(Vec3(0.5f, 0.5f, 2.5f), 1.0f, found);
+    ASSERT_EQUAL(1, (int)found.size());
+    ASSERT_EQUAL(player, found[0]);
+
+    found.clear();
+    physics.overlapBox({ Vec3(4.5f, 0.5f, -0.5f), Vec3(5.5f, 1.5f, 0.5f) }, found, COLLISION_LAYER_DEFAULT);
+    ASSERT_EQUAL(4, (int)found.size()); // wall cubes at y = 0, 1 and z = -1, 0
+
+    // Batched queries give the same answers as single ones
+    std::vector<RayQuery> rays;
+    for (int i = 0; i < 200; i++) {
+        rays.push_back({ Vec3(0, (i % 40) * 0.1f - 0.5f, (i / 40) * 0.5f - 1.0f), Vec3(1, 0.01f * (i % 7), 0), 10.0f });
+    }
+    std::vector<QueryHit> hits(rays.size());
+    physics.raycast(rays.data(), rays.size(), hits.data());
+    for (size_t i = 0; i < rays.size(); i++) {
+        physics.raycast(rays[i].origin, rays[i].direction, rays[i].maxDistance, hit);
+        ASSERT_EQUAL(hit.hit, hits[i].hit);
+        ASSERT_EQUAL(hit.entity, hits[i].entity);
+        ASSERT_TRUE(hit.distance == hits[i].distance);
+    }
+
+    for (Entity entity : entities) registry.destroyEntity(entity);
+}
@@ -0,0 +1,119 @@
+#include "SimpleTestFramework.h"
+#include "core/TimeSlicer.h"
+#include "managers/SystemManager.h"
+#include <thread>
+#include <chrono>
+
+TEST_CASE(TestSlicedTaskKeepsItsState) {
+    TimeSlicer slicer;
+    int steps = 0;
+    slicer.add([&steps, i = 0]() mutable {
+        steps++;
+        return ++i >= 3;
+    });
+
+    for (int frame = 0; frame < 10 && slicer.size(); frame++) {
+        slicer.run(0);
+    }
+    ASSERT_EQUAL(0, (int)slicer.size());
+    ASSERT_EQUAL(3, steps);
+}
+
+TEST_CASE(TestSlicedTasksStopAtBudget) {
+    TimeSlicer slicer;
+    int steps = 0;
+    slicer.add([&steps]() {
+        steps++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        return false;
+    });
+
+    // A step is never interrupted, but no other one starts after the budget is spent
+    slicer.run(1000);
+    ASSERT_EQUAL(1, steps);
+    slicer.run(1000);
+    ASSERT_EQUAL(2, steps);
+    ASSERT_EQUAL(1, (int)slicer.size());
+}
+
+TEST_CASE(TestSlicedTaskCancelDuringRun) {
+    TimeSlicer slicer;
+    int stepsA = 0, stepsB = 0, stepsC = 0;
+    SlicedTaskID b = 0, c = 0;
+    slicer.add([&]() {
+        stepsA++;
+        slicer.cancel(b);
+        return false;
+    });
+    b = slicer.add([&]() {
+        stepsB++;
+        return false;
+    });
+    c = slicer.add([&]() {
+        // Cancels itself on its second step
+        if (++stepsC == 2) slicer.cancel(c);
+        return false;
+    });
+
+    for (int frame = 0; frame < 4; frame++) {
+        slicer.run(0);
+    }
+    ASSERT_EQUAL(0, stepsB);
+    ASSERT_EQUAL(2, stepsC);
+    ASSERT_EQUAL(1, (int)slicer.size());
+    ASSERT_TRUE(stepsA >= 2);
+}
+
+template <int ID>
+class TickSystem : public ISystem {
+public:
+    std::vector<int> frames;
+    std::vector<float> deltas;
+    int frame = 0;
+    float phase;
+
+    TickSystem(float phase) : phase(phase) {}
+
+    int getPriority() override { return 0; }
+
+    const char* getName() override { return "TickSystem"; }
+
+    void processEvent(const Event& event, float deltaTime) override {}
+
+    void update(float deltaTime) override {
+        frames.push_back(frame);
+        deltas.push_back(deltaTime);
+    }
+
+    float getTickRate() override { return 10; }
+
+    float getTickPhase() override { return phase; }
+};
+
+TEST_CASE(TestSystemTickRateAndPhase) {
+    SystemManager& systemManager = SystemManager::getInstance();
+    auto first = systemManager.registerSystem<TickSystem<0>>(0.0f);
+    auto second = systemManager.registerSystem<TickSystem<1>>(-1.0f);
+
+    // 10 Hz at 60 frames per second ticks every sixth frame, first on the frame after registration
+    for (int frame = 0; frame < 60; frame++) {
+        first->frame = second->frame = frame;
+        systemManager.update(1.0f / 60.0f);
+    }
+    systemManager.removeSystem<TickSystem<0>>();
+    systemManager.removeSystem<TickSystem<1>>();
+
+    // Registered between frames, so the second tick comes a frame early: 0, 5, 11, ..., 59
+    ASSERT_EQUAL(11, (int)first->frames.size());
+    ASSERT_EQUAL(0, first->frames[0]);
+    for (size_t i = 2; i < first->frames.size(); i++) {
+        ASSERT_EQUAL(6, first->frames[i] - first->frames[i - 1]);
+        ASSERT_TRUE(std::abs(first->deltas[i] - 0.1f) < 0.001f);
+    }
+
+    // The second system with the same rate is spread onto other frames
+    ASSERT_EQUAL(10, (int)second->frames.size());
+    for (int frame : second->frames) {
+        ASSERT_TRUE(std::find(first->frames.begin(), first->frames.end(), frame) == first->frames.end());
+    }
+}
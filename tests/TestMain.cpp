@@ -0,0 +1,7 @@
+#include "SimpleTestFramework.h"
+
+// Every *Test.cpp registers its cases with TEST_CASE, they are all run from here
+int main() {
+    TestFramework::getInstance().runAllTests();
+    return 0;
+}
@@ -0,0 +1,20 @@
+#ifndef TEST_SCENES_H
+#define TEST_SCENES_H
+
+#include <vector>
+#include "managers/Registry.h"
+
+// Floor of static cubes covering y in [0, 1] around the origin
+inline std::vector<Entity> buildFloor(Registry& registry) {
+    std::vector<Entity> floor;
+    for (int x = -3; x <= 3; x++) {
+        for (int z = -3; z <= 3; z++) {
+            Entity entity = registry.createEntity();
+            registry.addComponent(entity, Transform(Vec3(x, 0, z)));
+            floor.push_back(entity);
+        }
+    }
+    return floor;
+}
+
+#endif
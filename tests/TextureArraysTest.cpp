@@ -0,0 +1,56 @@
+#include "SimpleTestFramework.h"
+#include "graphics/TextureArrays.h"
+
+// Headless texture with blank image data
+static std::shared_ptr<Texture> makeTexture(int width, int height) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA32);
+    return std::make_shared<Texture>(surface, false);
+}
+
+TEST_CASE(TestTextureLayersGroupBySize) {
+    TextureLayers layers;
+    auto a = makeTexture(64, 64), b = makeTexture(64, 64), c = makeTexture(32, 64);
+
+    TextureLayer la = layers.getLayer(a), lb = layers.getLayer(b), lc = layers.getLayer(c);
+    ASSERT_EQUAL(la.array, lb.array);
+    ASSERT_TRUE(la.layer != lb.layer);
+    ASSERT_TRUE(lc.array != la.array);
+    ASSERT_EQUAL(2, (int)layers.getArrayCount());
+
+    // Each texture is uploaded once, it keeps its layer afterwards
+    std::vector<TextureUpload> uploads;
+    layers.takeUploads(uploads);
+    ASSERT_EQUAL(3, (int)uploads.size());
+    ASSERT_EQUAL(la.pack(), layers.getLayer(a).pack());
+    uploads.clear();
+    layers.takeUploads(uploads);
+    ASSERT_EQUAL(0, (int)uploads.size());
+
+    ASSERT_EQUAL(TextureLayers::NO_ARRAY, layers.getLayer(nullptr).array);
+}
+
+TEST_CASE(TestTextureLayersReuseLayersOfFreedTextures) {
+    TextureLayers layers;
+    std::vector<std::shared_ptr<Texture>> textures;
+    for (int i = 0; i < TextureLayers::ARRAY_LAYERS; i++) {
+        textures.push_back(makeTexture(16, 16));
+        layers.getLayer(textures.back());
+    }
+    ASSERT_EQUAL(1, (int)layers.getArrayCount());
+    // Once uploaded only their owners keep the textures alive
+    std::vector<TextureUpload> uploads;
+    layers.takeUploads(uploads);
+    uploads.clear();
+
+    // A full array takes the layer of a texture that is gone before adding another array
+    TextureLayer freed = layers.getLayer(textures[3]);
+    textures[3].reset();
+    auto next = makeTexture(16, 16);
+    TextureLayer layer = layers.getLayer(next);
+    ASSERT_EQUAL(1, (int)layers.getArrayCount());
+    ASSERT_EQUAL(freed.pack(), layer.pack());
+    ASSERT_EQUAL(TextureLayers::ARRAY_LAYERS, (int)layers.getResidentCount());
+
+    layers.getLayer(makeTexture(16, 16));
+    ASSERT_EQUAL(2, (int)layers.getArrayCount());
+}
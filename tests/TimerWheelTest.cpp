@@ -0,0 +1,74 @@
+#include "SimpleTestFramework.h"
+#include "managers/TimerWheel.h"
+
+static Event timerEvent(int id) {
+    return { EVENT_TIMER, id };
+}
+
+TEST_CASE(TestTimerFiresOnce) {
+    TimerWheel wheel(0.001f);
+    std::vector<Event> due;
+    wheel.schedule(timerEvent(1), 0.5f);
+
+    wheel.advance(0.499f, due);
+    ASSERT_TRUE(due.empty());
+    wheel.advance(0.002f, due);
+    ASSERT_EQUAL(1, (int)due.size());
+    ASSERT_EQUAL(1, due[0].castData<int>());
+
+    wheel.advance(10.0f, due);
+    ASSERT_EQUAL(1, (int)due.size()); // one-shot timers only fire once
+    ASSERT_EQUAL(0, (int)wheel.size());
+}
+
+TEST_CASE(TestTimerPeriodic) {
+    TimerWheel wheel(0.001f);
+    std::vector<Event> due;
+    wheel.schedule(timerEvent(2), 0.25f, 0.25f);
+
+    for (int frame = 0; frame < 60; frame++) {
+        wheel.advance(1.0f / 60.0f, due);
+    }
+    ASSERT_EQUAL(4, (int)due.size()); // 0.25, 0.5, 0.75 and 1.0 seconds
+}
+
+TEST_CASE(TestTimerCancel) {
+    TimerWheel wheel(0.001f);
+    std::vector<Event> due;
+    TimerID a = wheel.schedule(timerEvent(3), 2.0f);
+    TimerID b = wheel.schedule(timerEvent(4), 2.0f);
+
+    ASSERT_TRUE(wheel.cancel(a));
+    ASSERT_TRUE(!wheel.cancel(a)); // already cancelled
+    wheel.advance(3.0f, due);
+    ASSERT_EQUAL(1, (int)due.size());
+    ASSERT_EQUAL(4, due[0].castData<int>());
+    ASSERT_TRUE(!wheel.cancel(b)); // already fired
+
+    // Reused pool slots must not be cancelled through stale handles
+    TimerID c = wheel.schedule(timerEvent(5), 1.0f);
+    ASSERT_TRUE(!wheel.cancel(a));
+    ASSERT_TRUE(wheel.isScheduled(c));
+}
+
+TEST_CASE(TestTimerCascade) {
+    TimerWheel wheel(0.001f);
+    std::vector<Event> due;
+    // Spread timers over every level of the wheel
+    float delays[] = { 0.01f, 0.1f, 3.0f, 70.0f, 300.0f, 5000.0f };
+    for (int i = 0; i < 6; i++) {
+        wheel.schedule(timerEvent(i), delays[i]);
+    }
+
+    float elapsed = 0.0f;
+    size_t fired = 0;
+    while (elapsed < 6000.0f) {
+        wheel.advance(0.5f, due);
+        elapsed += 0.5f;
+        for (; fired < due.size(); fired++) {
+            int i = due[fired].castData<int>();
+            ASSERT_TRUE(elapsed >= delays[i] && elapsed - delays[i] <= 0.5f);
+        }
+    }
+    ASSERT_EQUAL(6, (int)due.size());
+}
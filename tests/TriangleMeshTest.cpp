@@ -0,0 +1,120 @@
+#include "SimpleTestFramework.h"
+#include "systems/PhysicsSystem.h"
+#include "physics/Triangle.h"
+#include <random>
+
+// Bumpy n x n grid of quads, two triangles each
+static std::shared_ptr<TriangleMesh> makeGridMesh(int n) {
+    std::vector<Vec3> positions;
+    std::vector<uint32_t> indices;
+    for (int z = 0; z <= n; z++) {
+        for (int x = 0; x <= n; x++) positions.push_back(Vec3((float)x, std::sin(x * 0.7f) * std::cos(z * 0.5f), (float)z));
+    }
+    for (int z = 0; z < n; z++) {
+        for (int x = 0; x < n; x++) {
+            uint32_t i = z * (n + 1) + x;
+            indices.insert(indices.end(), { i, i + n + 1, i + 1, i + 1, i + n + 1, i + n + 2 });
+        }
+    }
+    return std::make_shared<TriangleMesh>(positions, indices);
+}
+
+TEST_CASE(TestTriangleMeshMatchesBruteForce) {
+    ASSERT_EQUAL(32, (int)sizeof(TriangleMesh::Node));
+
+    std::shared_ptr<TriangleMesh> mesh = makeGridMesh(16);
+    ASSERT_EQUAL(512, (int)mesh->getTriangleCount());
+    ASSERT_TRUE(mesh->getNodes().size() < 2 * mesh->getTriangleCount());
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> coordinate(-2.0f, 18.0f), unit(-1.0f, 1.0f);
+    for (int i = 0; i < 500; i++) {
+        Vec3 origin(coordinate(random), unit(random) * 3.0f, coordinate(random));
+        Vec3 direction = normalise(Vec3(unit(random), unit(random), unit(random)));
+
+        float nearest = 20.0f;
+        bool expected = false;
+        float closest = 1.5f;
+        bool near = false;
+        AABB box(origin, origin + Vec3(0.5f, 0.5f, 0.5f));
+        bool touching = false;
+        for (uint32_t triangle = 0; triangle < mesh->getTriangleCount(); triangle++) {
+            Vec3 a, b, c, normal;
+            mesh->getTriangle(triangle, a, b, c);
+            float t;
+            if (rayTriangle(origin, direction, nearest, a, b, c, t)) {
+                nearest = t;
+                expected = true;
+            }
+            float distance = length(closestPointOnTriangle(origin, a, b, c) - origin);
+            if (distance <= closest) {
+                closest = distance;
+                near = true;
+            }
+            touching |= sweepBoxTriangle(box, Vec3(0, 0, 0), a, b, c, t, normal);
+        }
+
+        MeshHit hit;
+        ASSERT_EQUAL(expected, mesh->raycast(origin, direction, 20.0f, hit));
+        if (expected) ASSERT_TRUE(std::fabs(hit.t - nearest) < 1e-4f && dot(hit.normal, direction) <= 0.0f);
+        ASSERT_EQUAL(near, mesh->closestPoint(origin, 1.5f, hit));
+        if (near) ASSERT_TRUE(std::fabs(hit.t - closest) < 1e-5f);
+        ASSERT_EQUAL(touching, mesh->overlaps(box));
+    }
+}
+
+TEST_CASE(TestTriangleMeshSweep) {
+    // Floor at y = 0 and a wall at x = 2
+    std::vector<Vec3> positions = { Vec3(0, 0, 0), Vec3(4, 0, 0), Vec3(4, 0, 4), Vec3(0, 0, 4),
+                                    Vec3(2, 0, 0), Vec3(2, 4, 0), Vec3(2, 4, 4), Vec3(2, 0, 4) };
+    TriangleMesh mesh(positions, { 0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7 });
+
+    MeshHit hit;
+    AABB box(Vec3(0.5f, 1.0f, 1.0f), Vec3(1.0f, 1.5f, 1.5f));
+    ASSERT_TRUE(mesh.sweep(box, Vec3(0, -1, 0), 5.0f, hit));
+    ASSERT_TRUE(std::fabs(hit.t - 1.0f) < 1e-5f);
+    ASSERT_TRUE(std::fabs(hit.normal.y - 1.0f) < 1e-5f);
+
+    ASSERT_TRUE(mesh.sweep(box, Vec3(1, 0, 0), 5.0f, hit));
+    ASSERT_TRUE(std::fabs(hit.t - 1.0f) < 1e-5f);
+    ASSERT_TRUE(std::fabs(hit.normal.x + 1.0f) < 1e-5f);
+    ASSERT_TRUE(!mesh.sweep(box, Vec3(1, 0, 0), 0.5f, hit));
+
+    ASSERT_TRUE(mesh.overlaps(Vec3(1, 0.5f, 1), 0.5f));
+    ASSERT_TRUE(!mesh.overlaps(Vec3(1, 0.5f, 1), 0.4f));
+    std::vector<uint32_t> found;
+    mesh.query(AABB(Vec3(1.5f, -0.5f, 1.5f), Vec3(2.5f, 0.5f, 2.5f)), found);
+    ASSERT_EQUAL(3, (int)found.size()); // both floor triangles, one of the wall
+}
+
+TEST_CASE(TestBodyRestsOnMesh) {
+    Registry& registry = Registry::getInstance();
+
+    std::vector<Vec3> positions = { Vec3(-5, 0, -5), Vec3(5, 0, -5), Vec3(5, 0, 5), Vec3(-5, 0, 5) };
+    auto mesh = std::make_shared<TriangleMesh>(positions, std::vector<uint32_t>{ 0, 2, 1, 0, 3, 2 });
+    Entity floor = registry.createEntity();
+    registry.addComponent(floor, Transform(Vec3(0, 2, 0)));
+    registry.addComponent(floor, Collider(COLLISION_LAYER_DEFAULT, mesh));
+
+    Entity body = registry.createEntity();
+    registry.addComponent(body, Transform(Vec3(0.3f, 2.5f, 0.3f)));
+    registry.addComponent(body, Physics(Vec3(0, 0, 0), Vec3(0, -9.812f, 0), 1.0f));
+
+    PhysicsSystem physics;
+    for (int step = 0; step < 240; step++) physics.update(1.0f / 60.0f);
+    float y = registry.getComponent<Transform>(body).position.y;
+    ASSERT_TRUE(y > 1.99f && y < 2.01f);
+    ASSERT_EQUAL(1, (int)physics.getSleepingCount());
+
+    QueryHit hit;
+    ASSERT_TRUE(physics.raycast(Vec3(3, 10, 3), Vec3(0, -1, 0), 20.0f, hit));
+    ASSERT_EQUAL(floor, hit.entity);
+    ASSERT_TRUE(std::fabs(hit.distance - 8.0f) < 1e-4f);
+
+    std::vector<Entity> found;
+    physics.overlapBox(AABB(Vec3(-3, 1.5f, -3), Vec3(-2, 2.5f, -2)), found);
+    ASSERT_EQUAL(1, (int)found.size());
+
+    registry.destroyEntity(floor);
+    registry.destroyEntity(body);
+}
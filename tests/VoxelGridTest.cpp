@@ -0,0 +1,108 @@
+#include "SimpleTestFramework.h"
+#include "physics/VoxelGrid.h"
+#include "systems/PhysicsSystem.h"
+
+TEST_CASE(TestVoxelGridOccupancy) {
+    VoxelGrid grid;
+    grid.set(0, 0, 0, 1);
+    grid.set(-1, 5, 17, 2); // negative and crossing into other chunks
+    ASSERT_EQUAL(2, (int)grid.size());
+    ASSERT_TRUE(grid.isSolid(0, 0, 0));
+    ASSERT_TRUE(grid.isSolid(-1, 5, 17));
+    ASSERT_TRUE(!grid.isSolid(15, 0, 0));
+    ASSERT_TRUE(!grid.isSolid(-1, 5, 1));
+    ASSERT_EQUAL(2, (int)grid.getEntity(-1, 5, 17));
+
+    grid.erase(0, 0, 0);
+    ASSERT_TRUE(!grid.isSolid(0, 0, 0));
+    ASSERT_EQUAL(1, (int)grid.size());
+
+    int x, y, z;
+    ASSERT_TRUE(VoxelGrid::toCell(Vec3(-3, 4.00001f, 2), x, y, z));
+    ASSERT_EQUAL(-3, x);
+    ASSERT_EQUAL(4, y);
+    ASSERT_TRUE(!VoxelGrid::toCell(Vec3(0.5f, 0, 0), x, y, z));
+}
+
+TEST_CASE(TestVoxelGridRaycast) {
+    VoxelGrid grid;
+    for (int x = -20; x <= 20; x++) {
+        for (int z = -20; z <= 20; z++) {
+            grid.set(x, 0, z, 7); // floor covering y in [0, 1]
+        }
+    }
+    grid.set(3, 1, 0, 8); // wall block on top of the floor
+
+    // Straight down onto the floor
+    VoxelHit hit;
+    ASSERT_TRUE(grid.raycast(Vec3(0.5f, 5.0f, 0.5f), Vec3(0, -1, 0), 10.0f, hit));
+    ASSERT_EQUAL(0, hit.y);
+    ASSERT_EQUAL(1, (int)hit.normal.y);
+    ASSERT_TRUE(hit.t > 3.99f && hit.t < 4.01f);
+
+    // Sideways into the wall block through its -x face
+    ASSERT_TRUE(grid.raycast(Vec3(0.5f, 1.5f, 0.5f), Vec3(1, 0, 0), 10.0f, hit));
+    ASSERT_EQUAL(3, hit.x);
+    ASSERT_EQUAL(-1, (int)hit.normal.x);
+    ASSERT_EQUAL(8, (int)hit.entity);
+    ASSERT_TRUE(hit.t > 2.49f && hit.t < 2.51f);
+
+    // Too short to reach, or pointing away
+    ASSERT_TRUE(!grid.raycast(Vec3(0.5f, 5.0f, 0.5f), Vec3(0, -1, 0), 3.9f, hit));
+    ASSERT_TRUE(!grid.raycast(Vec3(0.5f, 5.0f, 0.5f), Vec3(0, 1, 0), 100.0f, hit));
+
+    // A point resting on the floor face only hits when skipping its own cell is not asked for
+    ASSERT_TRUE(grid.raycast(Vec3(0.5f, 0.5f, 0.5f), Vec3(0, -1, 0), 0.1f, hit));
+    ASSERT_EQUAL(0.0f, hit.t);
+    ASSERT_TRUE(!grid.raycast(Vec3(0.5f, 1.5f, 0.5f), Vec3(0, -0.2f, 0), 1.0f, hit, true));
+    ASSERT_TRUE(grid.raycast(Vec3(0.5f, 1.1f, 0.5f), Vec3(0, -0.2f, 0), 1.0f, hit, true));
+    ASSERT_TRUE(hit.t > 0.49f && hit.t < 0.51f);
+}
+
+TEST_CASE(TestPhysicsKeepsGridInSync) {
+    Registry& registry = Registry::getInstance();
+    std::vector<Entity> floor;
+    for (int x = 0; x < 5; x++) {
+        for (int z = 0; z < 5; z++) {
+            Entity entity = registry.createEntity();
+            registry.addComponent(entity, Transform(Vec3(x, 0, z)));
+            floor.push_back(entity);
+        }
+    }
+    PhysicsSystem physics;
+    physics.update(1.0f / 60.0f);
+    uint32_t cubes = physics.getStats().staticCubes;
+    uint32_t colliders = physics.getStats().colliders;
+
+    // Only the changed entities are placed again, the registry logs which ones they are
+    uint64_t version = registry.getVersion();
+    Entity block = registry.createEntity();
+    registry.addComponent(block, Transform(Vec3(2, 1, 2)));
+    std::vector<Entity> changes;
+    ASSERT_TRUE(registry.getStructureChanges(version, changes));
+    ASSERT_EQUAL(1, (int)changes.size());
+    ASSERT_EQUAL(block, changes[0]);
+
+    VoxelHit hit;
+    physics.update(1.0f / 60.0f);
+    ASSERT_EQUAL(cubes + 1, physics.getStats().staticCubes);
+    ASSERT_TRUE(physics.raycastBlocks(Vec3(2.5f, 5, 2.5f), Vec3(0, -1, 0), 10.0f, hit));
+    ASSERT_EQUAL(block, hit.entity);
+
+    // A cube that becomes a body leaves the grid for the broadphase
+    registry.addComponent(block, Physics(Vec3(0, 0, 0), Vec3(0, 0, 0), 1.0f));
+    physics.update(1.0f / 60.0f);
+    ASSERT_EQUAL(cubes, physics.getStats().staticCubes);
+    ASSERT_EQUAL(colliders + 1, physics.getStats().colliders);
+    ASSERT_TRUE(physics.raycastBlocks(Vec3(2.5f, 5, 2.5f), Vec3(0, -1, 0), 10.0f, hit));
+    ASSERT_EQUAL(0, hit.y);
+
+    registry.destroyEntity(block);
+    registry.destroyEntity(floor[0]);
+    physics.update(1.0f / 60.0f);
+    ASSERT_EQUAL(colliders, physics.getStats().colliders);
+    ASSERT_EQUAL(cubes - 1, physics.getStats().staticCubes);
+    ASSERT_TRUE(!physics.raycastBlocks(Vec3(0.5f, 5, 0.5f), Vec3(0, -1, 0), 10.0f, hit));
+
+    for (size_t i = 1; i < floor.size(); i++) registry.destroyEntity(floor[i]);
+}